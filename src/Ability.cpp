@@ -4,21 +4,22 @@
 #include "Ability.hpp"
 #include "Player.hpp"
 #include "Projectile.hpp"
+#include "Game.hpp"
 
-void Ability::Activate(AbilityType abilityType, Player &sourcePlayer) {
+void Ability::Activate(AbilityType abilityType, Player &sourcePlayer, Game& game) {
     float SIDE_OFFSET = 0.0f;
     float DEPTH_OFFSET = 5.0f;
     float HEIGHT_OFFSET = -0.1f;
 
     switch (abilityType) {
         case BOMB:
-            m_projectiles.emplace_back(
+            game.SpawnProjectile(
                 sourcePlayer.position + SIDE_OFFSET * sourcePlayer.GetRight() + DEPTH_OFFSET * sourcePlayer.GetForward() + HEIGHT_OFFSET * sourcePlayer.GetUp(),
                 sourcePlayer.GetForward(),
                 ProjectileType::EXPLOSIVE,
-                PROJECTILE_STATS.at(ProjectileType::EXPLOSIVE).baseDamage
-            );       
-            m_projectiles.back().sourcePlayer = &sourcePlayer;
+                GetProjectileStats(ProjectileType::EXPLOSIVE).baseDamage,
+                sourcePlayer
+            );
             break;
 
         case TURBO:
@@ -1,52 +1,52 @@
 #pragma once
-#include <unordered_map>
+#include <array>
 #include <vector>
-#include <string>
 #include <glm/vec3.hpp>
+#include "StatTable.hpp"
 
 class Game;
 class Player;
-class Projectile;
 
 enum AbilityType {
     BOMB,
     TURBO
 };
 
+static constexpr int ABILITY_TYPE_COUNT = AbilityType::TURBO + 1;
+
 inline const std::vector<AbilityType> ABILITY_ORDER = {
     AbilityType::BOMB,
     AbilityType::TURBO
 };
 
 struct AbilityInfo {
-    std::string name;
+    AbilityType type;
+    const char* name;
     float cooldown;
 };
 
 class Ability {
 public:
-    std::vector<Projectile> m_projectiles;
-
-    void Activate(AbilityType abilityType, Player &sourcePlayer);
+    // Projectiles spawn straight into the game's pool
+    void Activate(AbilityType abilityType, Player &sourcePlayer, Game& game);
     void Update(float deltaTime);
-
-    void TransferProjectiles(std::vector<Projectile>& gameProjectiles) {
-        gameProjectiles.insert(gameProjectiles.end(), 
-            std::make_move_iterator(m_projectiles.begin()), 
-            std::make_move_iterator(m_projectiles.end())
-        );
-        m_projectiles.clear();
-    }
 };
 
-inline const std::unordered_map<AbilityType, AbilityInfo> ABILITY_PARAMS = {
-    { AbilityType::BOMB, {
+inline constexpr std::array<AbilityInfo, ABILITY_TYPE_COUNT> ABILITY_PARAMS = {{
+    {
+        .type = AbilityType::BOMB,
         .name = "Bomb",
         .cooldown = 10.0f
-    }}, 
+    }, 
 
-    {AbilityType::TURBO, {
+    {
+        .type = AbilityType::TURBO,
         .name = "Turbo",
         .cooldown = 5.0f
-    }}
-};
\ No newline at end of file
+    }
+}};
+static_assert(IsIndexedByType(ABILITY_PARAMS), "ABILITY_PARAMS must list every AbilityType in order");
+
+constexpr const AbilityInfo& GetAbilityInfo(AbilityType type) {
+    return ABILITY_PARAMS[static_cast<size_t>(type)];
+}
\ No newline at end of file
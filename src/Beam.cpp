@@ -0,0 +1,59 @@
+#include "Beam.hpp"
+#include "Game.hpp"
+#include "Player.hpp"
+#include "Projectile.hpp"
+#include <cmath>
+
+void Beam::Trigger(const glm::vec3& muzzleOffset) {
+    const ProjectileParams& stats = GetProjectileStats(ProjectileType::LASER);
+    // A fresh beam bites straight away instead of after its first interval
+    if (!IsActive()) m_timeSinceLastTick = stats.tickInterval;
+    m_muzzleOffset = muzzleOffset;
+    m_holdTime = stats.lifetime;
+}
+
+void Beam::Update(float deltaTime, Player& owner, std::vector<Player>& players, Game& game) {
+    if (!IsActive()) return;
+    m_holdTime -= deltaTime;
+
+    // Follow the ship every frame, the hit distance only changes on a tick
+    m_start = owner.position + m_muzzleOffset.x * owner.GetRight() + m_muzzleOffset.y * owner.GetUp() +
+        m_muzzleOffset.z * owner.GetForward();
+    m_direction = owner.GetForward();
+
+    const float tickInterval = GetProjectileStats(ProjectileType::LASER).tickInterval;
+    m_timeSinceLastTick += deltaTime;
+    if (m_timeSinceLastTick < tickInterval) return;
+
+    // Long frames still deal every tick they covered, from a single cast
+    const int ticks = static_cast<int>(m_timeSinceLastTick / tickInterval);
+    m_timeSinceLastTick -= ticks * tickInterval;
+    Cast(ticks, owner, players, game);
+}
+
+void Beam::Cast(int ticks, Player& owner, std::vector<Player>& players, Game& game) {
+    // Same reach the old bolts had over their lifetime
+    const ProjectileParams& stats = GetProjectileStats(ProjectileType::LASER);
+    m_length = stats.speed * stats.lifetime;
+
+    TerrainHit terrainHit;
+    if (game.RaycastTerrain(m_start, m_direction, m_length, terrainHit)) {
+        m_length = terrainHit.distance;
+    }
+
+    // Nearest ship in front of the terrain, ties go to the lowest player index
+    uint32_t hitIndex = UINT32_MAX;
+    float hitDistance = m_length;
+    game.GetShipGrid().ForEachRayHit(m_start, m_direction, m_length, stats.collisionRadius,
+        [&](const ShipGrid::Entry& ship, float distance) {
+            if (ship.team == owner.team || !players[ship.player].isAlive) return;
+            if (distance < hitDistance || (distance == hitDistance && ship.player < hitIndex)) {
+                hitDistance = distance;
+                hitIndex = ship.player;
+            }
+        });
+    if (hitIndex == UINT32_MAX) return;
+
+    m_length = hitDistance;
+    game.DamagePlayer(players[hitIndex], stats.damagePerTick * ticks, game.GetPlayerHandle(owner));
+}
\ No newline at end of file
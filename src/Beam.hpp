@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+
+class Game;
+class Player;
+
+// Continuous hitscan laser carried by its ship. Holding fire keeps it lit;
+// every tickInterval it casts one ray against ships and terrain and damages
+// the first ship in its path, instead of streaming hundreds of short bolts.
+class Beam {
+public:
+    // Keeps the beam lit for another hold window. The muzzle is in ship space (right, up, forward).
+    void Trigger(const glm::vec3& muzzleOffset);
+    void Update(float deltaTime, Player& owner, std::vector<Player>& players, Game& game);
+
+    bool IsActive() const { return m_holdTime > 0.0f; }
+    const glm::vec3& GetStart() const { return m_start; }
+    glm::vec3 GetEnd() const { return m_start + m_direction * m_length; }
+
+private:
+    glm::vec3 m_muzzleOffset{0.0f};
+    glm::vec3 m_start{0.0f};
+    glm::vec3 m_direction{0.0f, 0.0f, -1.0f};
+    float m_length = 0.0f;              // To whatever the last tick hit, or the full range
+    float m_holdTime = 0.0f;            // Left before the beam goes out without a new trigger
+    float m_timeSinceLastTick = 0.0f;
+
+    void Cast(int ticks, Player& owner, std::vector<Player>& players, Game& game);
+};
\ No newline at end of file
@@ -23,6 +23,32 @@ void Camera::ProcessMouseMovement(float xoffset, float yoffset) {
     m_pitch = glm::clamp(m_pitch, -89.0f, 89.0f);
 }
 
+Frustum Frustum::FromMatrix(const glm::mat4& m) {
+    // Gribb-Hartmann: each plane is the fourth row plus or minus one of the others
+    Frustum frustum;
+    for (int i = 0; i < 3; i++) {
+        glm::vec4 row(m[0][i], m[1][i], m[2][i], m[3][i]);
+        glm::vec4 last(m[0][3], m[1][3], m[2][3], m[3][3]);
+        frustum.planes[i * 2] = last + row;
+        frustum.planes[i * 2 + 1] = last - row;
+    }
+    for (auto& plane : frustum.planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
+
+bool Frustum::IntersectsAABB(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const {
+    for (const auto& plane : planes) {
+        // Corner furthest along the plane normal
+        glm::vec3 corner(plane.x >= 0.0f ? boundsMax.x : boundsMin.x,
+                         plane.y >= 0.0f ? boundsMax.y : boundsMin.y,
+                         plane.z >= 0.0f ? boundsMax.z : boundsMin.z);
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) return false;
+    }
+    return true;
+}
+
 glm::mat4 Camera::GetViewMatrix() const {
     return glm::lookAt(m_position, m_position + m_front, m_up);
 }
@@ -36,7 +62,7 @@ void Camera::Update(const Game& game, const glm::vec3& targetPosition, const glm
     glm::vec3 idealPosition = targetPosition + baseOffset + verticalOffset;
     m_position = glm::mix(m_position, idealPosition, 15.0f * deltaTime);
 
-    HandleCollision(game);
+    HandleCollision(game, targetPosition);
     
     // Calculate rolled "up" vector based on player's roll
     m_front = glm::normalize(adjustedTarget - m_position);
@@ -51,9 +77,16 @@ void Camera::Update(const Game& game, const glm::vec3& targetPosition, const glm
     m_up = glm::normalize(glm::cross(m_right, m_front));
 }
 
-void Camera::HandleCollision(const Game& game) {
+void Camera::HandleCollision(const Game& game, const glm::vec3& targetPosition) {
+    // Keep terrain from getting between the camera and the ship
+    const float cameraRadius = 0.3f;
+    TerrainHit hit;
+    if (game.SweepSphereTerrain(targetPosition, m_position, cameraRadius, hit)) {
+        m_position = glm::mix(targetPosition, m_position, hit.time);
+    }
+
     // Prevent camera from clipping through terrain
-    const float terrainHeight = game.GetTerrainHeight(m_position.x, m_position.z);
+    const float terrainHeight = game.SampleTerrain(m_position.x, m_position.z).height;
     const float minCameraHeight = terrainHeight + 1.5f; // 1.5m clearance
     
     if(m_position.y < minCameraHeight) {
@@ -61,7 +94,7 @@ void Camera::HandleCollision(const Game& game) {
     }
 
     // Optional: Add boundary constraints
-    const float boundary = Game::MAP_BOUNDARY - 2.0f;
+    const float boundary = game.GetMapBoundary() - 2.0f;
     m_position.x = glm::clamp(m_position.x, -boundary, boundary);
     m_position.z = glm::clamp(m_position.z, -boundary, boundary);
 }
\ No newline at end of file
@@ -4,6 +4,14 @@
 class Player; 
 class Game;
 
+// View frustum planes extracted from a view-projection matrix, normals point inwards
+struct Frustum {
+    glm::vec4 planes[6];
+
+    static Frustum FromMatrix(const glm::mat4& viewProjection);
+    bool IntersectsAABB(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+};
+
 class Camera {
 public:
     glm::vec3 m_position;
@@ -24,7 +32,7 @@ public:
         m_front = glm::vec3(0.0f, 0.0f, -1.0f);
     }
     void ProcessMouseMovement(float xoffset, float yoffset);
-    void HandleCollision(const Game& game);
+    void HandleCollision(const Game& game, const glm::vec3& targetPosition);
 
     glm::mat4 GetViewMatrix() const;
     glm::vec3 GetPosition() const { return m_position; }
@@ -3,12 +3,15 @@
 #include "Game.hpp"
 #include "Player.hpp"
 #include "Shaders.hpp"
+#include "TerrainCache.hpp"
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <chrono>
+#include <future>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/euler_angles.hpp>
@@ -50,12 +53,15 @@ bool Game::Initialize() {
     glEnable(GL_DEBUG_OUTPUT);
     bool InitSuccess = true;
 
+    // Settings first, the terrain bake depends on them
+    if (InitSuccess) InitSuccess = LoadPersistentSettings();
     if (InitSuccess) InitSuccess = InitializeShaders();
     if (InitSuccess) InitSuccess = LoadModels();
+    // Textures and fonts load while the terrain bakes in the background
     if (InitSuccess) InitSuccess = LoadTextures();
     if (InitSuccess) InitSuccess = LoadFonts();
+    if (InitSuccess) InitSuccess = FinishLoadingTerrain();
     if (InitSuccess) InitSuccess = LoadPlacements();
-    if (InitSuccess) InitSuccess = LoadPersistentSettings();
 
     if (m_fullscreen) {
         GLFWmonitor* monitor = glfwGetPrimaryMonitor();
@@ -89,6 +95,7 @@ bool Game::ReloadAssets() {
     if (InitSuccess) InitSuccess = LoadModels();
     if (InitSuccess) InitSuccess = LoadTextures();
     if (InitSuccess) InitSuccess = LoadFonts();
+    if (InitSuccess) InitSuccess = FinishLoadingTerrain();
     DefineButtons();
 
     glEnable(GL_DEPTH_TEST);
@@ -134,8 +141,64 @@ bool Game::InitializeShaders() {
         return false;
     }
 
+    // Terrain Shader Programs, same lighting as the models but holes are discarded
+    unsigned int terrainFS = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(terrainFS, 1, &terrainFragmentShader, NULL);
+    glCompileShader(terrainFS);
+    glGetShaderiv(terrainFS, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(terrainFS, 512, NULL, infoLog);
+        std::cerr << "Terrain fragment shader error:\n" << infoLog << std::endl;
+        return false;
+    }
+
+    unsigned int terrainVS = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(terrainVS, 1, &terrainVertexShader, NULL);
+    glCompileShader(terrainVS);
+    glGetShaderiv(terrainVS, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(terrainVS, 512, NULL, infoLog);
+        std::cerr << "Terrain vertex shader error:\n" << infoLog << std::endl;
+        return false;
+    }
+
+    m_terrainShaderProgram = glCreateProgram();
+    glAttachShader(m_terrainShaderProgram, terrainVS);
+    glAttachShader(m_terrainShaderProgram, terrainFS);
+    glLinkProgram(m_terrainShaderProgram);
+    glGetProgramiv(m_terrainShaderProgram, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(m_terrainShaderProgram, 512, NULL, infoLog);
+        std::cerr << "Terrain shader program error:\n" << infoLog << std::endl;
+        return false;
+    }
+
+    unsigned int heightfieldVS = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(heightfieldVS, 1, &heightfieldVertexShader, NULL);
+    glCompileShader(heightfieldVS);
+    glGetShaderiv(heightfieldVS, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(heightfieldVS, 512, NULL, infoLog);
+        std::cerr << "Heightfield vertex shader error:\n" << infoLog << std::endl;
+        return false;
+    }
+
+    m_heightfieldShaderProgram = glCreateProgram();
+    glAttachShader(m_heightfieldShaderProgram, heightfieldVS);
+    glAttachShader(m_heightfieldShaderProgram, terrainFS);
+    glLinkProgram(m_heightfieldShaderProgram);
+    glGetProgramiv(m_heightfieldShaderProgram, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(m_heightfieldShaderProgram, 512, NULL, infoLog);
+        std::cerr << "Heightfield shader program error:\n" << infoLog << std::endl;
+        return false;
+    }
+
     glDeleteShader(vertexShader);
+    glDeleteShader(terrainVS);
+    glDeleteShader(heightfieldVS);
     glDeleteShader(fragmentShader);
+    glDeleteShader(terrainFS);
 
     // UI Shader Program
     unsigned int uiVS = glCreateShader(GL_VERTEX_SHADER);
@@ -256,27 +319,72 @@ bool Game::InitializeShaders() {
 }
 
 bool Game::LoadModels() {
+    // A streamed world replaces the map, which then never loads or bakes
+    const bool worldOpen = !m_worldPath.empty() && OpenWorld();
     try {
-        m_mapModel =    new Model("assets/maps/map1.obj");
+        if (!worldOpen) {
+            m_mapModel = m_terrainSeed != 0 ? GenerateTerrainModel() : new Model(MAP_PATH);
+            m_mapModel->BuildChunks(MAP_CHUNK_SIZE);
+        }
         m_sunModel =    new Model("assets/models/sun.obj");
         m_bulletModel = new Model("assets/models/basicprojectile.obj");
         m_explosiveRoundModel = new Model("assets/models/basicprojectile.obj");
 
-        SHIP_STATS.at(ShipType::XR9).model =        new Model("assets/models/xr9.obj");
-        SHIP_STATS.at(ShipType::HellFire).model =   new Model("assets/models/hellfire.obj");
-        SHIP_STATS.at(ShipType::HYDRA).model =      new Model("assets/models/hydra.obj");
-        SHIP_STATS.at(ShipType::SPEAR).model =      new Model("assets/models/spear.obj");
+        m_shipModels[static_cast<size_t>(ShipType::XR9)] =      new Model("assets/models/xr9.obj");
+        m_shipModels[static_cast<size_t>(ShipType::HellFire)] = new Model("assets/models/hellfire.obj");
+        m_shipModels[static_cast<size_t>(ShipType::HYDRA)] =    new Model("assets/models/hydra.obj");
+        m_shipModels[static_cast<size_t>(ShipType::SPEAR)] =    new Model("assets/models/spear.obj");
 
     } catch (const std::exception& e) {
         std::cerr << "Model load error: " << e.what() << std::endl;
         return false;
     }
 
-    GenerateHeightmap(*m_mapModel);
+    // Generated maps have no source file to hash, so they always bake and never cache
+    if (!worldOpen) GenerateHeightmap(*m_mapModel, m_terrainSeed != 0 ? "" : MAP_PATH);
+
+    return true;
+}
+
+bool Game::FinishLoadingTerrain() {
+    if (m_world.IsActive()) return true;
+    FinishHeightmap();
+    if (!GetTerrainCollision()) return false;
+
+    const Heightfield& renderHeights = m_renderHeightfield.IsEmpty() ? GetTerrainCollision()->heightfield : m_renderHeightfield;
+    if (m_terrainVertexPulling) {
+        // The height texture replaces the map's mesh buffers, only collision still reads its vertices
+        if (m_heightfieldRenderer.Build(renderHeights, TERRAIN_LOD_VERTEX_SPACING)) m_mapModel->ReleaseBuffers();
+        std::cout << "Heightfield renderer: " << m_heightfieldRenderer.GetWidth() << "x" << m_heightfieldRenderer.GetDepth()
+                  << " texels, " << m_heightfieldRenderer.GetPatchCount() << " patches, "
+                  << m_heightfieldRenderer.GetMemoryUsage() / 1024 << " KB on the GPU ("
+                  << m_heightfieldRenderer.GetEquivalentMeshMemory() / 1024 << " KB as an indexed mesh)" << std::endl;
+    } else if (m_terrainLodError > 0.0f) {
+        m_terrainLOD.Build(renderHeights, TERRAIN_LOD_VERTEX_SPACING);
+    }
+    if (m_terrainQueryBenchmark) CompareTerrainQueryModes(10000);
+    if (m_terrainSamplingBenchmark) BenchmarkTerrainSampling(100000);
 
     return true;
 }
 
+bool Game::OpenWorld() {
+    // Tiles bake like the map does and share its collision cache format
+    const float cellSize = m_gridCellSize;
+    auto builder = [this, cellSize](const std::string& tilePath, std::vector<TerrainTriangle> triangles) {
+        auto terrain = std::make_unique<TerrainCollision>();
+        const TerrainCacheKey cacheKey{HashFileContents(tilePath), cellSize, m_heightfieldResolution, m_collisionTolerance};
+        const std::string cachePath = tilePath + ".collision";
+        if (cacheKey.sourceHash != 0 && LoadTerrainCache(cachePath, cacheKey, *terrain)) return terrain;
+
+        terrain = BuildTerrainCollision(BuildCollisionProxy(std::move(triangles), false), cellSize, false);
+        if (cacheKey.sourceHash != 0) SaveTerrainCache(cachePath, cacheKey, *terrain);
+        return terrain;
+    };
+    return m_world.Open(m_worldPath, static_cast<size_t>(m_worldMemoryBudgetMB) * 1024 * 1024,
+        m_worldStreamRadius, builder, m_threadPool);
+}
+
 bool Game::LoadTextures() {
     m_targetReticleTex = LoadTexture("assets/textures/reticle2.png",
             GL_MIRRORED_REPEAT, GL_CLAMP_TO_EDGE, GL_NEAREST, GL_NEAREST);
@@ -406,7 +514,7 @@ bool Game::LoadFonts() {
 
 bool Game::LoadPlacements() {
     m_players.clear();
-    m_projectiles.clear();
+    m_projectiles.SetCapacity(static_cast<size_t>(std::max(m_projectileCapacity, 0)));
     m_particles.Clear();
 
     switch (currentState) {
@@ -455,7 +563,17 @@ bool Game::LoadPlacements() {
             m_players.back().m_shipType = ShipType::HYDRA; 
         
             for (Player &player : m_players) {
+                // Handles taken on the previous placement stop resolving
+                player.generation = ++m_playerGeneration;
                 player.InitializeStats();
+                if (m_world.IsActive() || m_terrainSeed != 0) player.MAP_BOUNDARY = GetMapBoundary();
+            }
+
+            // The match start is the one place a stall is fine, every ship begins on loaded ground
+            if (currentState == GameState::PLAYING && m_world.IsActive()) {
+                m_worldAnchors.clear();
+                for (const Player& player : m_players) m_worldAnchors.push_back(player.position);
+                m_world.Preload(m_worldAnchors);
             }
         }
     }
@@ -478,6 +596,23 @@ bool Game::LoadPersistentSettings() {
             else if (key == "render_distance") m_renderDistance = std::stoi(value);
             else if (key == "night_mode") m_nightMode = std::stoi(value);
             else if (key == "hide_hud") m_hideHud = std::stoi(value);
+            else if (key == "heightfield_resolution") m_heightfieldResolution = std::stof(value);
+            else if (key == "terrain_query_mode") m_terrainQueryMode = static_cast<TerrainQueryMode>(std::stoi(value));
+            else if (key == "terrain_lod_error") m_terrainLodError = std::stof(value);
+            else if (key == "terrain_vertex_pulling") m_terrainVertexPulling = std::stoi(value);
+            else if (key == "world") m_worldPath = value;
+            else if (key == "world_memory_budget_mb") m_worldMemoryBudgetMB = std::stoi(value);
+            else if (key == "world_stream_radius") m_worldStreamRadius = std::stof(value);
+            else if (key == "terrain_seed") m_terrainSeed = static_cast<uint32_t>(std::stoul(value));
+            else if (key == "terrain_resolution") m_terrainResolution = std::stoi(value);
+            else if (key == "terrain_size") m_terrainSize = std::stof(value);
+            else if (key == "terrain_generator_benchmark") m_terrainGeneratorBenchmark = std::stoi(value);
+            else if (key == "collision_tolerance") m_collisionTolerance = std::stof(value);
+            else if (key == "collision_proxy_benchmark") m_collisionProxyBenchmark = std::stoi(value);
+            else if (key == "terrain_query_benchmark") m_terrainQueryBenchmark = std::stoi(value);
+            else if (key == "terrain_sampling_benchmark") m_terrainSamplingBenchmark = std::stoi(value);
+            else if (key == "projectile_capacity") m_projectileCapacity = std::stoi(value);
+            else if (key == "explosion_occlusion") m_explosionOcclusion = std::stoi(value);
         }
     }
     file.close();
@@ -495,16 +630,117 @@ bool Game::SavePersistentSettings() {
     file << "render_distance=" << m_renderDistance << "\n";
     file << "night_mode=" << m_nightMode << "\n";
     file << "hide_hud=" << m_hideHud << "\n";
+    file << "heightfield_resolution=" << m_heightfieldResolution << "\n";
+    file << "terrain_query_mode=" << static_cast<int>(m_terrainQueryMode) << "\n";
+    file << "terrain_lod_error=" << m_terrainLodError << "\n";
+    file << "terrain_vertex_pulling=" << m_terrainVertexPulling << "\n";
+    file << "world=" << m_worldPath << "\n";
+    file << "world_memory_budget_mb=" << m_worldMemoryBudgetMB << "\n";
+    file << "world_stream_radius=" << m_worldStreamRadius << "\n";
+    file << "terrain_seed=" << m_terrainSeed << "\n";
+    file << "terrain_resolution=" << m_terrainResolution << "\n";
+    file << "terrain_size=" << m_terrainSize << "\n";
+    file << "terrain_generator_benchmark=" << m_terrainGeneratorBenchmark << "\n";
+    file << "collision_tolerance=" << m_collisionTolerance << "\n";
+    file << "collision_proxy_benchmark=" << m_collisionProxyBenchmark << "\n";
+    file << "terrain_query_benchmark=" << m_terrainQueryBenchmark << "\n";
+    file << "terrain_sampling_benchmark=" << m_terrainSamplingBenchmark << "\n";
+    file << "projectile_capacity=" << m_projectileCapacity << "\n";
+    file << "explosion_occlusion=" << m_explosionOcclusion << "\n";
     file.close();
     return true;
 }
 
-void Game::GenerateHeightmap(const Model& terrainModel) {
-    std::lock_guard<std::mutex> lock(m_spatialGridMutex);
-    m_spatialGrid.clear();
+void Game::GenerateHeightmap(const Model& terrainModel, const std::string& sourcePath) {
     const float cellSize = 0.75f;
-    m_gridCellSize = cellSize; 
+    m_gridCellSize = cellSize;
+
+    // Copy the triangles out now, the model's GL side keeps changing on this thread
+    std::vector<TerrainTriangle> triangles = ExtractTerrainTriangles(terrainModel);
+    m_renderHeightfield.Clear();
+
+    // Build into a private snapshot off the main thread, FinishHeightmap publishes it
+    m_terrainBakeStart = std::chrono::high_resolution_clock::now();
+    m_terrainBake = std::async(std::launch::async, [this, triangles = std::move(triangles), sourcePath, cellSize]() mutable {
+        auto loadStart = std::chrono::high_resolution_clock::now();
+        auto terrain = std::make_unique<TerrainCollision>();
+        const TerrainCacheKey cacheKey{HashFileContents(sourcePath), cellSize, m_heightfieldResolution, m_collisionTolerance};
+        const std::string cachePath = sourcePath + ".collision";
+        // The proxy collides coarser than the mesh, so the renderers need the full-detail heights
+        const bool needsRenderHeights = m_collisionTolerance > 0.0f && (m_terrainVertexPulling || m_terrainLodError > 0.0f);
+
+        if (cacheKey.sourceHash != 0 && LoadTerrainCache(cachePath, cacheKey, *terrain, &m_renderHeightfield)) {
+            std::cout << "Terrain collision (warm start): loaded " << terrain->triangles.size() << " triangles from "
+                      << cachePath << " in " << std::chrono::duration<float, std::milli>(
+                             std::chrono::high_resolution_clock::now() - loadStart).count() << " ms" << std::endl;
+            if (!m_renderHeightfield.Validate(triangles.size())) m_renderHeightfield.Clear();
+            // Cached by a run that drew from the mesh, bake once and store it for the next start
+            if (needsRenderHeights && m_renderHeightfield.IsEmpty()) {
+                BakeRenderHeightfield(triangles);
+                SaveTerrainCache(cachePath, cacheKey, *terrain, &m_renderHeightfield);
+            }
+        } else {
+            terrain = BuildTerrainCollision(BuildCollisionProxy(triangles, true), cellSize, true);
+            if (needsRenderHeights) BakeRenderHeightfield(triangles);
+            const bool cached = cacheKey.sourceHash != 0 && SaveTerrainCache(cachePath, cacheKey, *terrain, &m_renderHeightfield);
+            std::cout << "Terrain collision (cold start): built" << (cached ? " and cached" : ", not cached,") << " in "
+                      << std::chrono::duration<float, std::milli>(
+                             std::chrono::high_resolution_clock::now() - loadStart).count() << " ms on "
+                      << m_threadPool.GetThreadCount() << " workers" << std::endl;
+        }
 
+        if (m_collisionProxyBenchmark && m_collisionTolerance > 0.0f) {
+            CompareCollisionProxy(triangles, *terrain, cellSize, 100000);
+        }
+        return terrain;
+    });
+}
+
+void Game::FinishHeightmap() {
+    if (!m_terrainBake.valid()) return;
+
+    auto waitStart = std::chrono::high_resolution_clock::now();
+    std::unique_ptr<TerrainCollision> terrain = m_terrainBake.get();
+    auto waitEnd = std::chrono::high_resolution_clock::now();
+    std::cout << "Terrain bake overlapped " << std::chrono::duration<float, std::milli>(waitStart - m_terrainBakeStart).count()
+              << " ms of asset loading, main thread waited " << std::chrono::duration<float, std::milli>(waitEnd - waitStart).count()
+              << " ms" << std::endl;
+
+    // Publish, the snapshot is read-only from here on
+    m_terrainCollision.store(terrain.get(), std::memory_order_release);
+    m_terrainSnapshots.push_back(std::move(terrain));
+}
+
+Model* Game::GenerateTerrainModel() {
+    TerrainGeneratorSettings settings;
+    settings.seed = m_terrainSeed;
+    settings.resolution = m_terrainResolution;
+    settings.size = 2.0f * GetMapBoundary();
+
+    if (m_terrainGeneratorBenchmark) {
+        TerrainGenerator::Benchmark(settings, m_threadPool, {256, 1024, 4096});
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<float> heights;
+    TerrainGenerator::GenerateHeights(settings, m_threadPool, heights);
+    auto noiseEnd = std::chrono::high_resolution_clock::now();
+
+    std::vector<glm::vec3> positions, normals;
+    std::vector<unsigned int> indices;
+    TerrainGenerator::BuildMesh(settings, heights, m_threadPool, positions, normals, indices);
+    Model* model = new Model(positions, normals, indices);
+    auto meshEnd = std::chrono::high_resolution_clock::now();
+
+    std::cout << "Generated terrain (seed " << m_terrainSeed << "): " << settings.resolution << "x" << settings.resolution
+              << " samples in " << std::chrono::duration<float, std::milli>(noiseEnd - start).count() << " ms, mesh "
+              << indices.size() / 3 << " triangles in " << std::chrono::duration<float, std::milli>(meshEnd - noiseEnd).count()
+              << " ms on " << m_threadPool.GetThreadCount() << " threads" << std::endl;
+    return model;
+}
+
+std::vector<TerrainTriangle> Game::ExtractTerrainTriangles(const Model& terrainModel) {
+    std::vector<TerrainTriangle> triangles;
     for (const auto& mesh : terrainModel.Getmeshes()) {
         const auto& vertices = terrainModel.GetVertices();
         const auto& indices = mesh.indices;
@@ -537,108 +773,385 @@ void Game::GenerateHeightmap(const Model& terrainModel) {
             glm::vec3 edge2 = tri.v2 - tri.v0;
             tri.normal = glm::normalize(glm::cross(edge1, edge2));
 
-            // Calculate tight AABB
-            glm::vec3 minBounds = glm::min(tri.v0, glm::min(tri.v1, tri.v2));
-            glm::vec3 maxBounds = glm::max(tri.v0, glm::max(tri.v1, tri.v2));
+            triangles.push_back(tri);
+        }
+    }
+    return triangles;
+}
+
+static void GetTerrainBoundsXZ(const std::vector<TerrainTriangle>& triangles, glm::vec2& terrainMin, glm::vec2& terrainMax) {
+    terrainMin = glm::vec2(FLT_MAX);
+    terrainMax = glm::vec2(-FLT_MAX);
+    for (const TerrainTriangle& tri : triangles) {
+        glm::vec3 minBounds = glm::min(tri.v0, glm::min(tri.v1, tri.v2));
+        glm::vec3 maxBounds = glm::max(tri.v0, glm::max(tri.v1, tri.v2));
+        terrainMin = glm::min(terrainMin, glm::vec2(minBounds.x, minBounds.z));
+        terrainMax = glm::max(terrainMax, glm::vec2(maxBounds.x, maxBounds.z));
+    }
+}
 
-            // Convert bounds to grid coordinates
-            int startX = static_cast<int>(std::floor(minBounds.x / cellSize));
-            int endX = static_cast<int>(std::ceil(maxBounds.x / cellSize));
-            int startZ = static_cast<int>(std::floor(minBounds.z / cellSize));
-            int endZ = static_cast<int>(std::ceil(maxBounds.z / cellSize));
+std::vector<TerrainTriangle> Game::BuildCollisionProxy(std::vector<TerrainTriangle> triangles, bool verbose) const {
+    if (m_collisionTolerance <= 0.0f) return triangles;
 
-            // Add triangle to all covered cells
-            for (int x = startX; x <= endX; x++) {
-                for (int z = startZ; z <= endZ; z++) {
-                    m_spatialGrid[{x, z}].push_back(tri);
-                }
-            }
+    auto simplifyStart = std::chrono::high_resolution_clock::now();
+    TerrainProxyStats stats;
+    std::vector<TerrainTriangle> proxy = SimplifyTerrain(triangles, m_collisionTolerance, &stats);
+    auto simplifyEnd = std::chrono::high_resolution_clock::now();
+
+    if (verbose) {
+        std::cout << "Collision proxy: " << stats.sourceTriangles << " -> " << stats.proxyTriangles << " triangles, "
+                  << stats.sourceVertices << " -> " << stats.proxyVertices << " vertices, within " << stats.errorBound
+                  << " of the render mesh, simplified in "
+                  << std::chrono::duration<float, std::milli>(simplifyEnd - simplifyStart).count() << " ms" << std::endl;
+    }
+    return proxy;
+}
+
+void Game::BakeRenderHeightfield(const std::vector<TerrainTriangle>& triangles) {
+    // Same bake as the collision heightfield, just from every render triangle
+    TerrainCollision source;
+    source.triangles = triangles;
+    source.grid.Build(source.triangles, m_gridCellSize, &m_threadPool);
+    glm::vec2 terrainMin, terrainMax;
+    GetTerrainBoundsXZ(source.triangles, terrainMin, terrainMax);
+    m_renderHeightfield.Build(terrainMin, terrainMax, m_heightfieldResolution,
+        [&source](float x, float z) { return source.SampleFromGrid(x, z); }, &m_threadPool);
+}
+
+void Game::CompareCollisionProxy(const std::vector<TerrainTriangle>& renderTriangles, const TerrainCollision& proxy,
+    float cellSize, int sampleCount) {
+    if (proxy.heightfield.IsEmpty() || sampleCount <= 0) return;
+    std::unique_ptr<TerrainCollision> full = BuildTerrainCollision(renderTriangles, cellSize, false);
+
+    // Fixed pseudo-random points over the baked area so every run measures the same work
+    const glm::vec2 minBounds = proxy.heightfield.GetMinBounds();
+    const glm::vec2 maxBounds = proxy.heightfield.GetMaxBounds();
+    std::vector<glm::vec2> points(sampleCount);
+    uint32_t seed = 12345u;
+    for (auto& point : points) {
+        seed = seed * 1664525u + 1013904223u;
+        point.x = glm::mix(minBounds.x, maxBounds.x, (seed >> 8) / 16777215.0f);
+        seed = seed * 1664525u + 1013904223u;
+        point.y = glm::mix(minBounds.y, maxBounds.y, (seed >> 8) / 16777215.0f);
+    }
+
+    // Height error against the exact render surface
+    float maxError = 0.0f;
+    double errorSum = 0.0;
+    int measured = 0;
+    for (const auto& point : points) {
+        float fullHeight = full->SampleFromGrid(point.x, point.y).height;
+        float proxyHeight = proxy.SampleFromGrid(point.x, point.y).height;
+        if (fullHeight == Heightfield::NO_TERRAIN || proxyHeight == Heightfield::NO_TERRAIN) continue;
+        maxError = std::max(maxError, std::abs(fullHeight - proxyHeight));
+        errorSum += std::abs(fullHeight - proxyHeight);
+        measured++;
+    }
+
+    // Accumulate results so the compiler can't drop the loops
+    auto timeQueries = [&points](const TerrainCollision& terrain, float& sampleNs, float& raycastNs, float& checksum) {
+        auto sampleStart = std::chrono::high_resolution_clock::now();
+        for (const auto& point : points) {
+            checksum += terrain.SampleFromGrid(point.x, point.y).height;
         }
+        auto raycastStart = std::chrono::high_resolution_clock::now();
+        const glm::vec3 dir = glm::normalize(glm::vec3(0.3f, -1.0f, 0.2f));
+        for (const auto& point : points) {
+            TerrainHit hit;
+            if (terrain.Raycast(glm::vec3(point.x, 100.0f, point.y), dir, 300.0f, hit)) checksum += hit.distance;
+        }
+        auto raycastEnd = std::chrono::high_resolution_clock::now();
+        sampleNs = std::chrono::duration<float, std::nano>(raycastStart - sampleStart).count() / points.size();
+        raycastNs = std::chrono::duration<float, std::nano>(raycastEnd - raycastStart).count() / points.size();
+    };
+    float fullSampleNs, fullRaycastNs, proxySampleNs, proxyRaycastNs, checksum = 0.0f;
+    timeQueries(*full, fullSampleNs, fullRaycastNs, checksum);
+    timeQueries(proxy, proxySampleNs, proxyRaycastNs, checksum);
+
+    std::cout << "Collision proxy vs render mesh: " << proxy.triangles.size() << " / " << full->triangles.size()
+              << " triangles, " << proxy.GetMemoryUsage() / 1024 << " / " << full->GetMemoryUsage() / 1024 << " KB, sample "
+              << proxySampleNs << " / " << fullSampleNs << " ns, raycast " << proxyRaycastNs << " / " << fullRaycastNs
+              << " ns, height error max " << maxError << " mean " << (measured > 0 ? errorSum / measured : 0.0)
+              << " over " << measured << " points (checksum " << checksum << ")" << std::endl;
+}
+
+std::unique_ptr<TerrainCollision> Game::BuildTerrainCollision(std::vector<TerrainTriangle> triangles,
+    float cellSize, bool verbose) {
+    auto terrain = std::make_unique<TerrainCollision>();
+    auto gridStart = std::chrono::high_resolution_clock::now();
+    terrain->triangles = std::move(triangles);
+
+    // Tight XZ bounds for the heightfield
+    glm::vec2 terrainMin, terrainMax;
+    GetTerrainBoundsXZ(terrain->triangles, terrainMin, terrainMax);
+
+    // Cells store indices into the shared triangle array
+    terrain->grid.Build(terrain->triangles, cellSize, &m_threadPool);
+    auto gridEnd = std::chrono::high_resolution_clock::now();
+
+    if (verbose) {
+        std::cout << "Spatial grid: " << terrain->triangles.size() << " triangles, "
+                  << terrain->grid.GetCellCount() << " cells, " << terrain->grid.GetReferenceCount() << " references, "
+                  << (terrain->triangles.size() * sizeof(Triangle) + terrain->grid.GetMemoryUsage()) / 1024 << " KB, built in "
+                  << std::chrono::duration<float, std::milli>(gridEnd - gridStart).count() << " ms" << std::endl;
+    }
+
+    // Bake the heightfield from the grid so both query modes agree on the samples
+    auto bakeStart = std::chrono::high_resolution_clock::now();
+    const TerrainCollision& source = *terrain;
+    terrain->heightfield.Build(terrainMin, terrainMax, m_heightfieldResolution,
+        [&source](float x, float z) { return source.SampleFromGrid(x, z); }, &m_threadPool);
+    auto bakeEnd = std::chrono::high_resolution_clock::now();
+
+    if (verbose) {
+        std::cout << "Heightfield: " << terrain->heightfield.GetWidth() << "x" << terrain->heightfield.GetDepth()
+                  << " samples, " << terrain->heightfield.GetMemoryUsage() / 1024 << " KB, baked in "
+                  << std::chrono::duration<float, std::milli>(bakeEnd - bakeStart).count() << " ms" << std::endl;
+    }
+
+    auto bvhStart = std::chrono::high_resolution_clock::now();
+    terrain->bvh.Build(terrain->triangles);
+    auto bvhEnd = std::chrono::high_resolution_clock::now();
+
+    if (verbose) {
+        std::cout << "Terrain BVH: " << terrain->bvh.GetNodeCount() << " nodes, "
+                  << terrain->bvh.GetMemoryUsage() / 1024 << " KB, built in "
+                  << std::chrono::duration<float, std::milli>(bvhEnd - bvhStart).count() << " ms" << std::endl;
     }
+
+    const float pyramidCellSize = 2.0f;
+    terrain->pyramid.Build(terrain->triangles, pyramidCellSize);
+    if (verbose) {
+        std::cout << "Height pyramid: " << terrain->pyramid.GetLevelCount() << " levels, "
+                  << terrain->pyramid.GetMemoryUsage() / 1024 << " KB" << std::endl;
+    }
+
+    // Distance field for sphere-traced sweeps, needs the BVH for its nearest-point queries
+    auto sdfStart = std::chrono::high_resolution_clock::now();
+    const float sdfSpacing = 1.0f;
+    const float sdfBand = 4.0f;
+    terrain->distanceField.Build(terrain->triangles, terrain->bvh, sdfSpacing, sdfBand, &m_threadPool);
+    auto sdfEnd = std::chrono::high_resolution_clock::now();
+
+    if (verbose) {
+        glm::ivec3 sdfSize = terrain->distanceField.GetSize();
+        std::cout << "Terrain distance field: " << sdfSize.x << "x" << sdfSize.y << "x" << sdfSize.z << " samples, "
+                  << terrain->distanceField.GetMemoryUsage() / 1024 << " KB, built in "
+                  << std::chrono::duration<float, std::milli>(sdfEnd - sdfStart).count() << " ms" << std::endl;
+    }
+
+    return terrain;
 }
 
-float Game::GetTerrainHeight(float x, float z) const {
-    std::lock_guard<std::mutex> lock(m_spatialGridMutex);
+static_assert(std::atomic<const TerrainCollision*>::is_always_lock_free,
+    "Terrain snapshot reads must not fall back to a lock");
 
-    const float queryRadius = 0.8f; // Account for collision radius
-    float minX = x - queryRadius;
-    float maxX = x + queryRadius;
-    float minZ = z - queryRadius;
-    float maxZ = z + queryRadius;
+void Game::ReclaimTerrainSnapshots() {
+    // Only safe between frames, when no terrain query can still hold an old pointer
+    if (m_terrainSnapshots.size() > 1) {
+        m_terrainSnapshots.erase(m_terrainSnapshots.begin(), m_terrainSnapshots.end() - 1);
+    }
+}
 
-    float maxHeight = -FLT_MAX;
-    
-    // Check all grid cells in the search area
-    for (int gridX = static_cast<int>(std::floor(minX / m_gridCellSize)); 
-         gridX <= static_cast<int>(std::ceil(maxX / m_gridCellSize)); 
-         gridX++) {
-        for (int gridZ = static_cast<int>(std::floor(minZ / m_gridCellSize));
-             gridZ <= static_cast<int>(std::ceil(maxZ / m_gridCellSize));
-             gridZ++) {
-            if (!m_spatialGrid.count({gridX, gridZ})) continue;
-            
-            for (const Triangle& tri : m_spatialGrid.at({gridX, gridZ})) {
-                // Perform precise ray-triangle intersection
-                glm::vec3 origin(x, 1000.0f, z);
-                glm::vec3 dir(0.0f, -1.0f, 0.0f);
-                
-                float t = 0.0f;
-                glm::vec2 baryPosition; // Variable to store barycentric coordinates
-                if (glm::intersectRayTriangle(origin, dir, tri.v0, tri.v1, tri.v2, baryPosition, t)) {
-                    float yHeight = origin.y + dir.y * t;
-                    maxHeight = std::max(maxHeight, yHeight);
-                }
-            }
+void Game::CompareTerrainQueryModes(int sampleCount) const {
+    const TerrainCollision* terrain = GetTerrainCollision();
+    if (!terrain) return;
+
+    // Sample a regular pattern over the playable area
+    const int side = std::max(1, static_cast<int>(std::sqrt(static_cast<float>(sampleCount))));
+    const float boundary = GetMapBoundary();
+    const float step = (2.0f * boundary) / side;
+    float maxError = 0.0f;
+    double totalError = 0.0;
+    int compared = 0;
+
+    for (int i = 0; i < side; i++) {
+        for (int j = 0; j < side; j++) {
+            float x = -boundary + (i + 0.5f) * step;
+            float z = -boundary + (j + 0.5f) * step;
+            float reference = terrain->GetHeightFromGrid(x, z);
+            if (reference == Heightfield::NO_TERRAIN) continue;
+
+            float error = std::abs(terrain->GetHeightFromMap(x, z) - reference);
+            maxError = std::max(maxError, error);
+            totalError += error;
+            compared++;
         }
     }
-    
-    return maxHeight > -FLT_MAX ? maxHeight : -1000.0f;
+
+    std::cout << "Heightfield vs grid over " << compared << " samples: max error " << maxError
+              << ", mean error " << (compared ? totalError / compared : 0.0) << std::endl;
+}
+
+const TerrainCollision* Game::GetTerrainAt(float x, float z) const {
+    if (m_world.IsActive()) return m_world.FindCollision(x, z);
+    return GetTerrainCollision();
+}
+
+float Game::GetTerrainHeight(float x, float z) const {
+    const TerrainCollision* terrain = GetTerrainAt(x, z);
+    if (!terrain) return Heightfield::NO_TERRAIN;
+
+    if (m_terrainQueryMode == TerrainQueryMode::GRID || terrain->heightfield.IsEmpty()) {
+        return terrain->GetHeightFromGrid(x, z);
+    }
+    return terrain->GetHeightFromMap(x, z);
+}
+
+float Game::GetHeightFromMap(float x, float z) const {
+    const TerrainCollision* terrain = GetTerrainAt(x, z);
+    return terrain ? terrain->GetHeightFromMap(x, z) : Heightfield::NO_TERRAIN;
+}
+
+float Game::GetHeightFromGrid(float x, float z) const {
+    const TerrainCollision* terrain = GetTerrainAt(x, z);
+    return terrain ? terrain->GetHeightFromGrid(x, z) : Heightfield::NO_TERRAIN;
+}
+
+static void QueryHeights(const TerrainCollision* terrain, bool useGrid, const glm::vec2* xz, float* out, size_t count) {
+    if (!terrain) {
+        std::fill(out, out + count, Heightfield::NO_TERRAIN);
+        return;
+    }
+
+    if (useGrid || terrain->heightfield.IsEmpty()) {
+        terrain->GetHeightsFromGrid(xz, out, count);
+    } else {
+        terrain->GetHeightsFromMap(xz, out, count);
+    }
+}
+
+void Game::QueryTerrainHeights(const glm::vec2* xz, float* out, size_t count) const {
+    const bool useGrid = m_terrainQueryMode == TerrainQueryMode::GRID;
+    if (!m_world.IsActive()) {
+        QueryHeights(GetTerrainCollision(), useGrid, xz, out, count);
+        return;
+    }
+
+    // Consecutive points over the same tile still go through the batched kernels together
+    size_t start = 0;
+    while (start < count) {
+        const TerrainCollision* terrain = m_world.FindCollision(xz[start].x, xz[start].y);
+        size_t end = start + 1;
+        while (end < count && m_world.FindCollision(xz[end].x, xz[end].y) == terrain) end++;
+        QueryHeights(terrain, useGrid, xz + start, out + start, end - start);
+        start = end;
+    }
 }
 
 glm::vec3 Game::GetTerrainNormal(float x, float z) const {
-    const float queryRadius = 0.8f; // Match collision check radius
-    float minX = x - queryRadius;
-    float maxX = x + queryRadius;
-    float minZ = z - queryRadius;
-    float maxZ = z + queryRadius;
-
-    // Check all grid cells in the search area
-    for (int gridX = static_cast<int>(std::floor(minX / m_gridCellSize)); 
-         gridX <= static_cast<int>(std::ceil(maxX / m_gridCellSize)); 
-         gridX++) {
-        for (int gridZ = static_cast<int>(std::floor(minZ / m_gridCellSize));
-             gridZ <= static_cast<int>(std::ceil(maxZ / m_gridCellSize));
-             gridZ++) {
-            const auto cellKey = std::make_pair(gridX, gridZ);
-            if (!m_spatialGrid.count(cellKey)) continue;
-            
-            for (const Triangle& tri : m_spatialGrid.at(cellKey)) {
-                if (IsPointInTriangleXZ(glm::vec2(x, z), tri)) {
-                    return tri.normal;
-                }
-            }
+    const TerrainCollision* terrain = GetTerrainAt(x, z);
+    if (!terrain) return glm::vec3(0.0f, 1.0f, 0.0f);
+
+    if (m_terrainQueryMode == TerrainQueryMode::GRID || terrain->heightfield.IsEmpty()) {
+        return terrain->GetNormalFromGrid(x, z);
+    }
+    return terrain->GetNormalFromMap(x, z);
+}
+
+TerrainSample Game::SampleTerrain(float x, float z) const {
+    const TerrainCollision* terrain = GetTerrainAt(x, z);
+    if (!terrain) return TerrainSample{Heightfield::NO_TERRAIN};
+
+    if (m_terrainQueryMode == TerrainQueryMode::GRID || terrain->heightfield.IsEmpty()) {
+        return terrain->SampleFromGrid(x, z);
+    }
+    return terrain->SampleFromMap(x, z);
+}
+
+void Game::BenchmarkTerrainSampling(int sampleCount) const {
+    if (!GetTerrainCollision() || sampleCount <= 0) return;
+
+    // Fixed pseudo-random points so every run measures the same work
+    const float boundary = GetMapBoundary();
+    std::vector<glm::vec2> points(sampleCount);
+    uint32_t seed = 12345u;
+    for (auto& point : points) {
+        seed = seed * 1664525u + 1013904223u;
+        point.x = ((seed >> 8) / 16777215.0f * 2.0f - 1.0f) * boundary;
+        seed = seed * 1664525u + 1013904223u;
+        point.y = ((seed >> 8) / 16777215.0f * 2.0f - 1.0f) * boundary;
+    }
+
+    // Accumulate results so the compiler can't drop the loops
+    float separateSum = 0.0f, fusedSum = 0.0f;
+    auto separateStart = std::chrono::high_resolution_clock::now();
+    for (const auto& point : points) {
+        separateSum += GetTerrainHeight(point.x, point.y) + GetTerrainNormal(point.x, point.y).y;
+    }
+    auto fusedStart = std::chrono::high_resolution_clock::now();
+    for (const auto& point : points) {
+        TerrainSample sample = SampleTerrain(point.x, point.y);
+        fusedSum += sample.height + sample.normal.y;
+    }
+    auto fusedEnd = std::chrono::high_resolution_clock::now();
+
+    // Both sides answer through the current query mode, so they must agree point for point
+    int mismatches = 0;
+    for (const auto& point : points) {
+        TerrainSample sample = SampleTerrain(point.x, point.y);
+        if (sample.height != GetTerrainHeight(point.x, point.y) || sample.normal != GetTerrainNormal(point.x, point.y)) {
+            mismatches++;
         }
     }
-    return glm::vec3(0.0f, 1.0f, 0.0f); // Fallback
+
+    float separateNs = std::chrono::duration<float, std::nano>(fusedStart - separateStart).count() / sampleCount;
+    float fusedNs = std::chrono::duration<float, std::nano>(fusedEnd - fusedStart).count() / sampleCount;
+    const char* mode = m_terrainQueryMode == TerrainQueryMode::GRID ? "grid" : "heightfield";
+    std::cout << "Terrain sampling over " << sampleCount << " " << mode << " queries: height + normal " << separateNs
+              << " ns, fused " << fusedNs << " ns per query, " << mismatches << " mismatches (checksums "
+              << separateSum << ", " << fusedSum << ")" << std::endl;
 }
 
-bool Game::IsPointInTriangleXZ(const glm::vec2& point, const Triangle& tri) const {
-    const float epsilon = 0.001f;
-    glm::vec2 a(tri.v0.x, tri.v0.z);
-    glm::vec2 b(tri.v1.x, tri.v1.z);
-    glm::vec2 c(tri.v2.x, tri.v2.z);
+bool Game::IsAboveTerrain(const glm::vec3& from, const glm::vec3& to, float radius) const {
+    bool anyTerrain = false;
+    bool above = true;
+    ForEachTerrainAlong(from, to, radius, [&](const TerrainCollision& terrain) {
+        anyTerrain = true;
+        above = above && terrain.pyramid.IsAbove(from, to, radius);
+    });
+    if (!anyTerrain) return true;
 
-    glm::vec2 v0 = b - a;
-    glm::vec2 v1 = c - a;
-    glm::vec2 v2 = point - a;
+    m_terrainChecks.fetch_add(1, std::memory_order_relaxed);
+    if (above) {
+        m_terrainEarlyOuts.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
 
-    float den = v0.x * v1.y - v1.x * v0.y;
-    if (std::abs(den) < epsilon) return false;
-    
-    float u = (v2.x * v1.y - v2.y * v1.x) / den;
-    float v = (v2.y * v0.x - v2.x * v0.y) / den;
-    
-    return (u >= -epsilon) && (v >= -epsilon) && (u + v <= 1.0f + epsilon);
+bool Game::RaycastTerrain(const glm::vec3& origin, const glm::vec3& dir, float maxDist, TerrainHit& hit) const {
+    // Tiles can overlap at their seams, keep the nearest hit
+    bool found = false;
+    ForEachTerrainAlong(origin, origin + dir * maxDist, 0.0f, [&](const TerrainCollision& terrain) {
+        TerrainHit tileHit;
+        if (terrain.Raycast(origin, dir, maxDist, tileHit) && (!found || tileHit.distance < hit.distance)) {
+            hit = tileHit;
+            found = true;
+        }
+    });
+    return found;
+}
+
+bool Game::SweepSphereTerrain(const glm::vec3& from, const glm::vec3& to, float radius, TerrainHit& hit) const {
+    bool found = false;
+    ForEachTerrainAlong(from, to, radius, [&](const TerrainCollision& terrain) {
+        TerrainHit tileHit;
+        if (terrain.SweepSphere(from, to, radius, tileHit) && (!found || tileHit.time < hit.time)) {
+            hit = tileHit;
+            found = true;
+        }
+    });
+    return found;
+}
+
+bool Game::HasLineOfSight(const glm::vec3& from, const glm::vec3& to) const {
+    glm::vec3 delta = to - from;
+    float distance = glm::length(delta);
+    if (distance < 0.001f) return true;
+
+    TerrainHit hit;
+    return !RaycastTerrain(from, delta / distance, distance, hit);
 }
 
 void Game::CreateUIElement(UIElement& element, const char* texturePath, glm::vec2 pos, glm::vec2 size) {
@@ -1073,6 +1586,21 @@ void Game::HandleEvents() {
 
 void Game::Update(float deltaTime) {
     m_totalTime += deltaTime;
+    ReclaimTerrainSnapshots();
+
+    // Stream world tiles around the ship while playing, around the camera in the menus.
+    // Live ships anchor the ground under them, the main player's first so it never loses out to the budget.
+    if (m_world.IsActive()) {
+        bool hasPlayer = currentState == GameState::PLAYING && m_mainPlayerIndex < m_players.size();
+        m_worldAnchors.clear();
+        if (hasPlayer && m_players[m_mainPlayerIndex].IsAlive()) m_worldAnchors.push_back(m_players[m_mainPlayerIndex].position);
+        if (currentState == GameState::PLAYING) {
+            for (size_t i = 0; i < m_players.size(); i++) {
+                if (i != m_mainPlayerIndex && m_players[i].IsAlive()) m_worldAnchors.push_back(m_players[i].position);
+            }
+        }
+        m_world.Update(hasPlayer ? m_players[m_mainPlayerIndex].position : m_camera.GetPosition(), m_worldAnchors);
+    }
 
     ProcessMouseInput();
     ProcessKeyboardInput();
@@ -1120,9 +1648,14 @@ void Game::UpdateStartScreen(float deltaTime) {
 
     m_camera.m_front = glm::normalize(front);
 
+    SetLighting(glm::vec3(1.0f, 0.95f, 0.9f));
+}
+
+void Game::SetLighting(const glm::vec3& lightColor) {
+    m_lightColor = lightColor;
     glUseProgram(m_shaderProgram);
     glUniform3fv(glGetUniformLocation(m_shaderProgram, "lightPos"), 1, &m_sunPosition[0]);
-    glUniform3f(glGetUniformLocation(m_shaderProgram, "lightColor"), 1.0f, 0.95f, 0.9f);
+    glUniform3fv(glGetUniformLocation(m_shaderProgram, "lightColor"), 1, &m_lightColor[0]);
     glUniform3fv(glGetUniformLocation(m_shaderProgram, "viewPos"), 1, &m_camera.GetPosition()[0]);
 }
 
@@ -1138,10 +1671,7 @@ void Game::UpdateShipSelectScreen(float deltaTime) {
     m_camera.m_front = glm::normalize(lookDir);
 
     // Maintain lighting uniforms
-    glUseProgram(m_shaderProgram);
-    glUniform3fv(glGetUniformLocation(m_shaderProgram, "lightPos"), 1, &m_sunPosition[0]);
-    glUniform3f(glGetUniformLocation(m_shaderProgram, "lightColor"), 0.7f, 0.665f, 0.63f);
-    glUniform3fv(glGetUniformLocation(m_shaderProgram, "viewPos"), 1, &m_camera.GetPosition()[0]);
+    SetLighting(glm::vec3(0.7f, 0.665f, 0.63f));
 
     // Handle ship selection bounds
     if(m_selectedShipIndex < 0) m_selectedShipIndex = SHIP_STATS.size() - 1;
@@ -1154,18 +1684,12 @@ void Game::UpdateModeSelectScreen(float deltaTime) {
 
 void Game::UpdatePauseScreen(float deltaTime) {
     // Maintain lighting uniforms
-    glUseProgram(m_shaderProgram);
-    glUniform3fv(glGetUniformLocation(m_shaderProgram, "lightPos"), 1, &m_sunPosition[0]);
-    glUniform3f(glGetUniformLocation(m_shaderProgram, "lightColor"), 1.0f, 0.95f, 0.9f);
-    glUniform3fv(glGetUniformLocation(m_shaderProgram, "viewPos"), 1, &m_camera.GetPosition()[0]);
+    SetLighting(glm::vec3(1.0f, 0.95f, 0.9f));
 }
 
 void Game::UpdateSettingsScreen(float deltaTime) {
     // Maintain lighting uniforms
-    glUseProgram(m_shaderProgram);
-    glUniform3fv(glGetUniformLocation(m_shaderProgram, "lightPos"), 1, &m_sunPosition[0]);
-    glUniform3f(glGetUniformLocation(m_shaderProgram, "lightColor"), 1.0f, 0.95f, 0.9f);
-    glUniform3fv(glGetUniformLocation(m_shaderProgram, "viewPos"), 1, &m_camera.GetPosition()[0]);
+    SetLighting(glm::vec3(1.0f, 0.95f, 0.9f));
 }
 
 void Game::UpdateGameOverWinScreen(float deltaTime) {
@@ -1189,10 +1713,7 @@ void Game::UpdatePlaying(float deltaTime) {
     HandleEntityDestruction();
 
     // Update lighting uniforms
-    glUseProgram(m_shaderProgram);
-    glUniform3fv(glGetUniformLocation(m_shaderProgram, "lightPos"), 1, &m_sunPosition[0]);
-    glUniform3f(glGetUniformLocation(m_shaderProgram, "lightColor"), 1.0f, 0.95f, 0.9f);
-    glUniform3fv(glGetUniformLocation(m_shaderProgram, "viewPos"), 1, &m_camera.GetPosition()[0]);
+    SetLighting(glm::vec3(1.0f, 0.95f, 0.9f));
     
     // Set default glow parameters
     glUseProgram(m_shaderProgram);
@@ -1212,6 +1733,34 @@ void Game::DebugOutput(float deltaTime) {
         std::cout << "Player Position: " << m_players[m_mainPlayerIndex].position.x << ", "
                   << m_players[m_mainPlayerIndex].position.y << ", "
                   << m_players[m_mainPlayerIndex].position.z << "\n";
+
+        uint64_t terrainChecks = m_terrainChecks.exchange(0, std::memory_order_relaxed);
+        uint64_t terrainEarlyOuts = m_terrainEarlyOuts.exchange(0, std::memory_order_relaxed);
+        std::cout << "Map Chunks: " << m_visibleMapChunkCount << " visible, " << m_culledMapChunkCount << " culled\n";
+        if (m_terrainLodError > 0.0f && !m_terrainLOD.IsEmpty()) {
+            const TerrainLOD::FrameStats& lodStats = m_terrainLOD.GetFrameStats();
+            std::cout << "Terrain LOD (tiles/triangles per level):";
+            for (int level = 0; level < TerrainLOD::LEVEL_COUNT; level++) {
+                std::cout << " L" << level << " " << lodStats.tiles[level] << "/" << lodStats.triangles[level];
+            }
+            std::cout << ", " << lodStats.culledTiles << " culled\n";
+        }
+        if (m_terrainVertexPulling && !m_heightfieldRenderer.IsEmpty()) {
+            const HeightfieldRenderer::FrameStats& heightfieldStats = m_heightfieldRenderer.GetFrameStats();
+            std::cout << "Heightfield Patches: " << heightfieldStats.patches << " drawn in 1 call ("
+                      << heightfieldStats.triangles << " triangles), " << heightfieldStats.culledPatches << " culled\n";
+        }
+        if (m_world.IsActive()) {
+            const TerrainWorld::Stats& worldStats = m_world.GetStats();
+            std::cout << "World Tiles: " << worldStats.residentTiles << " resident ("
+                      << worldStats.residentBytes / (1024 * 1024) << " / " << m_worldMemoryBudgetMB << " MB), "
+                      << worldStats.loadingTiles << " loading, " << worldStats.drawnTiles << " drawn\n";
+        }
+        std::cout << "Projectiles: " << m_projectiles.Size() << " live, " << m_projectileCapacity << " per type, "
+                  << m_projectiles.GetDroppedSpawns() << " dropped\n";
+        std::cout << "Terrain Early-Outs: " << terrainEarlyOuts << " / " << terrainChecks;
+        if (terrainChecks > 0) std::cout << " (" << (100.0 * terrainEarlyOuts / terrainChecks) << "%)";
+        std::cout << "\n";
         
         debugUpdateTimer = 0.0f;
     }
@@ -1219,6 +1768,7 @@ void Game::DebugOutput(float deltaTime) {
 
 void Game::UpdateAllPlayers(float deltaTime) {
     for(auto& player : m_players) {
+        player.previousPosition = player.position;
         if (!player.IsAlive()) continue;
         if(player.isAI) {
             player.UpdateAI(deltaTime, m_players[m_mainPlayerIndex].position, *this);
@@ -1226,23 +1776,56 @@ void Game::UpdateAllPlayers(float deltaTime) {
         else {
             player.Update(m_window, deltaTime, *this);
         }
-        player.TransferProjectiles(m_projectiles);
     }
 }
 
+void Game::DamagePlayer(Player& target, float damage, PlayerHandle source) {
+    // The owner may have been removed since firing, the hit still counts without a hitmarker
+    Player* sourcePlayer = ResolvePlayer(source);
+    bool killed = target.TakeDamage(damage, *this);
+
+    // Only trigger hitmarker if the MAIN PLAYER is the source
+    if (sourcePlayer && sourcePlayer->isMainPlayer) {
+        if (killed) {
+            sourcePlayer->lastKillTime = m_totalTime;
+            ReportPlayerKilled();
+        } else {
+            sourcePlayer->lastHitTime = m_totalTime;
+            ReportPlayerHit();
+        }
+    }
+}
+
+PlayerHandle Game::GetPlayerHandle(const Player& player) const {
+    return PlayerHandle{static_cast<uint32_t>(&player - m_players.data()), player.generation};
+}
+
+Player* Game::ResolvePlayer(PlayerHandle handle) {
+    if (!handle.IsValid() || handle.index >= m_players.size()) return nullptr;
+    Player& player = m_players[handle.index];
+    return player.generation == handle.generation ? &player : nullptr;
+}
+
+ProjectileHandle Game::SpawnProjectile(const glm::vec3& position, const glm::vec3& direction, ProjectileType type,
+    float damage, const Player& source) {
+    return m_projectiles.Spawn(position, direction, type, damage, GetPlayerHandle(source), source.team);
+}
+
+size_t Game::SpawnVolley(const glm::vec3* positions, const glm::vec3* directions, size_t count, ProjectileType type,
+    float damage, const Player& source) {
+    return m_projectiles.SpawnVolley(positions, directions, count, type, damage, GetPlayerHandle(source), source.team);
+}
+
 void Game::UpdateProjectiles(float deltaTime) {
-    for(auto& projectile : m_projectiles) {
-        projectile.Update(deltaTime, m_players, *this);
+    m_shipGrid.Build(m_players, SHIP_GRID_CELL_SIZE);
+    m_projectiles.Update(deltaTime, m_players, *this);
+    for (Player& player : m_players) {
+        if (player.IsAlive()) player.m_beam.Update(deltaTime, player, m_players, *this);
     }
 }
 
 void Game::HandleEntityDestruction() {
-    // Projectiles
-    auto projectileEnd = std::remove_if(
-        m_projectiles.begin(), m_projectiles.end(),
-        [](const Projectile& p) { return p.ShouldDestroy(); }
-    );
-    m_projectiles.erase(projectileEnd, m_projectiles.end());
+    m_projectiles.RemoveDestroyed();
 }
 
 void Game::Render() {
@@ -1381,7 +1964,7 @@ void Game::RenderStartScreen() {
     
     glUniformMatrix4fv(glGetUniformLocation(m_shaderProgram, "view"), 1, GL_FALSE, &view[0][0]);
     glUniformMatrix4fv(glGetUniformLocation(m_shaderProgram, "projection"), 1, GL_FALSE, &projection[0][0]);
-    RenderMap();
+    RenderMap(view, projection);
 
     // Render UI elements
     glDisable(GL_DEPTH_TEST);
@@ -1466,12 +2049,12 @@ void Game::RenderShipSelectScreen() {
     glUniformMatrix4fv(glGetUniformLocation(m_shaderProgram, "projection"), 1, GL_FALSE, &projection[0][0]);
     
     // Darken the scene by reducing light intensity
-    glUniform3f(glGetUniformLocation(m_shaderProgram, "lightColor"), 0.6f, 0.57f, 0.54f);
-    RenderMap();
+    SetLighting(glm::vec3(0.6f, 0.57f, 0.54f));
+    RenderMap(view, projection);
 
     // 2. Render rotating ship model
     ShipType selectedType = SHIP_ORDER[m_selectedShipIndex];
-    Model* shipModel = SHIP_STATS.at(selectedType).model;
+    Model* shipModel = GetShipModel(selectedType);
 
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(-6.0f, 1.0f, -41.0f)); // Fixed position
@@ -1479,7 +2062,7 @@ void Game::RenderShipSelectScreen() {
     model = glm::scale(model, glm::vec3(0.25f));
 
     glUniformMatrix4fv(glGetUniformLocation(m_shaderProgram, "model"), 1, GL_FALSE, &model[0][0]);
-    glUniform3f(glGetUniformLocation(m_shaderProgram, "lightColor"), 1.0f, 1.0f, 1.0f);
+    SetLighting(glm::vec3(1.0f));
     glUniform3f(glGetUniformLocation(m_shaderProgram, "objectColor"), 1.0f, 1.0f, 1.0f);
     shipModel->Draw(m_shaderProgram);
     
@@ -1492,22 +2075,22 @@ void Game::RenderShipSelectScreen() {
     int width, height;
     glfwGetWindowSize(m_window, &width, &height);
 
-    std::string planeName = SHIP_STATS.at(selectedType).name;
+    std::string planeName = GetShipStats(selectedType).name;
     float ndcX = 0.0f;
     float ndcY = 0.1f;
     RenderText(planeName, glm::vec2(0.0f, 0.1f), glm::vec2(0.5f, 0.1f), glm::vec3(1.0f));
 
     // Define stat names and values
-    const ShipStats& stats = SHIP_STATS.at(selectedType);
+    const ShipStats& stats = GetShipStats(selectedType);
 
-    ProjectileType selectedProjectileType = SHIP_STATS.at(selectedType).projectileType;
+    ProjectileType selectedProjectileType = GetShipStats(selectedType).projectileType;
     std::ostringstream fireRateStream;
     fireRateStream << std::fixed << std::setprecision(1) << (1 / stats.fireRate);
 
     std::vector<std::pair<std::string, std::string>> statLines = {
         {"Max Health:   ", std::to_string(static_cast<int>(stats.maxHealth))},
         {"", ""},
-        {"Projectile:   ", (selectedProjectileType == ProjectileType::NONE) ? "NONE" : PROJECTILE_STATS.at(selectedProjectileType).name},
+        {"Projectile:   ", (selectedProjectileType == ProjectileType::NONE) ? "NONE" : GetProjectileStats(selectedProjectileType).name},
         {"Fire Rate:    ", (selectedProjectileType == ProjectileType::NONE) ? "NONE" : fireRateStream.str()},
         {"", ""},
         {"Max Speed:    ", std::to_string(static_cast<int>(stats.maxSpeed))},
@@ -1598,7 +2181,7 @@ void Game::DefineShipSelectButtons() {
         {   // Ability 1
             .position = {0.6f, 0.8f},
             .size = {0.1f, 0.1f},
-            .text = ABILITY_PARAMS.at(m_chosenAbilities.first).name,
+            .text = GetAbilityInfo(m_chosenAbilities.first).name,
             .action = [this]() {
                 chooseAbilityState = true;
                 m_selectedAbility = 1; 
@@ -1607,7 +2190,7 @@ void Game::DefineShipSelectButtons() {
         {   // Ability 2
             .position = {0.6f, 0.6f},
             .size = {0.1f, 0.1f},
-            .text = ABILITY_PARAMS.at(m_chosenAbilities.second).name,
+            .text = GetAbilityInfo(m_chosenAbilities.second).name,
             .action = [this]() {
                 chooseAbilityState = true;
                 m_selectedAbility = 2; 
@@ -1668,7 +2251,7 @@ void Game::DefineChooseAbilityPopUpButtons() {
         {   // CURRENT ABILITY 1
             .position = {-0.3f, 0.6f},
             .size = {0.1f, 0.1f},
-            .text = ABILITY_PARAMS.at(m_chosenAbilities.first).name,
+            .text = GetAbilityInfo(m_chosenAbilities.first).name,
             .action = [this]() {
                 m_selectedAbility = 1; 
             }
@@ -1676,7 +2259,7 @@ void Game::DefineChooseAbilityPopUpButtons() {
         {   // CURRENT ABILITY 2
             .position = {0.3f, 0.6f},
             .size = {0.1f, 0.1f},
-            .text = ABILITY_PARAMS.at(m_chosenAbilities.second).name,
+            .text = GetAbilityInfo(m_chosenAbilities.second).name,
             .action = [this]() {
                 m_selectedAbility = 2;
             }
@@ -2210,16 +2793,29 @@ void Game::Render3D() {
     glUniformMatrix4fv(glGetUniformLocation(m_shaderProgram, "view"), 1, GL_FALSE, &m_camera.GetViewMatrix()[0][0]);
     glUniformMatrix4fv(glGetUniformLocation(m_shaderProgram, "projection"), 1, GL_FALSE, &m_projection[0][0]);
 
-    RenderMap();
+    RenderMap(view, proj);
     RenderEntities();
     RenderParticles();
 }
 
-void Game::RenderMap() {
-    if (!m_mapModel) return;
+// Binds one of the terrain programs with the map transform and the model shader's lighting
+void Game::UseTerrainShader(unsigned int program, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection) {
+    glUseProgram(program);
+    glUniformMatrix4fv(glGetUniformLocation(program, "model"), 1, GL_FALSE, &model[0][0]);
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, &view[0][0]);
+    glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, &projection[0][0]);
+    glUniform3f(glGetUniformLocation(program, "objectColor"), 0.8f, 0.8f, 0.8f);
+    glUniform3fv(glGetUniformLocation(program, "lightPos"), 1, &m_sunPosition[0]);
+    glUniform3fv(glGetUniformLocation(program, "lightColor"), 1, &m_lightColor[0]);
+    glUniform3fv(glGetUniformLocation(program, "viewPos"), 1, &m_camera.GetPosition()[0]);
+}
+
+void Game::RenderMap(const glm::mat4& view, const glm::mat4& projection) {
+    if (!m_mapModel && !m_world.IsActive()) return;
     // Set up model matrix
+    const glm::vec3 mapOffset(0.0f, -10.0f, 0.0f);
     glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(0.0f, -10.0f, 0.0f)); // Lower position
+    model = glm::translate(model, mapOffset); // Lower position
     model = glm::scale(model, glm::vec3(1.0f)); // Start with scale 1.0
 
     // Set shader uniforms
@@ -2231,8 +2827,45 @@ void Game::RenderMap() {
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LESS);
 
-    // Draw map
-    m_mapModel->Draw(m_shaderProgram);
+    // Streamed tiles replace the single map entirely
+    if (m_world.IsActive()) {
+        m_world.Draw(view, projection, mapOffset, m_renderDistance);
+        return;
+    }
+
+    // Whole map in one instanced call, positions and normals come from the height texture
+    if (m_terrainVertexPulling && !m_heightfieldRenderer.IsEmpty()) {
+        UseTerrainShader(m_heightfieldShaderProgram, model, view, projection);
+        m_heightfieldRenderer.Draw(m_heightfieldShaderProgram, view, projection, mapOffset, m_renderDistance);
+        glUseProgram(m_shaderProgram);
+        return;
+    }
+
+    // Heightfield mesh with per-tile detail, 0 in settings.cfg keeps the original mesh
+    if (m_terrainLodError > 0.0f && !m_terrainLOD.IsEmpty()) {
+        UseTerrainShader(m_terrainShaderProgram, model, view, projection);
+        m_terrainLOD.Draw(view, projection, mapOffset, m_terrainLodError, m_heigth, m_renderDistance);
+        glUseProgram(m_shaderProgram);
+        return;
+    }
+
+    // Draw only the chunks in front of the camera and within render distance
+    const Frustum frustum = Frustum::FromMatrix(projection * view);
+    const glm::vec3 eye = glm::vec3(glm::inverse(view)[3]);
+    const auto& chunks = m_mapModel->GetChunks();
+    m_visibleMapChunks.clear();
+    for (unsigned int i = 0; i < chunks.size(); i++) {
+        glm::vec3 boundsMin = chunks[i].boundsMin + mapOffset;
+        glm::vec3 boundsMax = chunks[i].boundsMax + mapOffset;
+        glm::vec3 nearest = glm::clamp(eye, boundsMin, boundsMax);
+        if (glm::length(nearest - eye) > m_renderDistance) continue;
+        if (!frustum.IntersectsAABB(boundsMin, boundsMax)) continue;
+        m_visibleMapChunks.push_back(i);
+    }
+    m_visibleMapChunkCount = static_cast<unsigned int>(m_visibleMapChunks.size());
+    m_culledMapChunkCount = static_cast<unsigned int>(chunks.size()) - m_visibleMapChunkCount;
+
+    m_mapModel->DrawChunks(m_visibleMapChunks);
 }
 
 void Game::RenderEntities() {
@@ -2246,7 +2879,7 @@ void Game::RenderPlayers() {
     for(auto& player : m_players) {
         if (!player.IsAlive()) continue;
 
-        const auto& ShipModel = SHIP_STATS.at(player.m_shipType).model;
+        Model* ShipModel = GetShipModel(player.m_shipType);
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::translate(model, player.position);
         model *= glm::mat4_cast(player.rotation);
@@ -2281,67 +2914,72 @@ void Game::RenderPlayers() {
 }
 
 void Game::RenderProjectiles() {
-    for (const auto& projectile : m_projectiles) {
-        if (projectile.type == ProjectileType::BULLET) {
-            glUseProgram(m_shaderProgram);
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), projectile.position);
+    const ProjectileBatch& bullets = m_projectiles.GetBatch(ProjectileType::BULLET);
+    if (bullets.Size() > 0) {
+        glUseProgram(m_shaderProgram);
+        glUniform3f(glGetUniformLocation(m_shaderProgram, "objectColor"), 
+            1.0f, 0.2f, 0.2f);
+        for (size_t i = 0; i < bullets.Size(); i++) {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), bullets.GetPosition(i));
             model = glm::scale(model, glm::vec3(0.07f));
             glUniformMatrix4fv(glGetUniformLocation(m_shaderProgram, "model"), 
                 1, GL_FALSE, &model[0][0]);
-            glUniform3f(glGetUniformLocation(m_shaderProgram, "objectColor"), 
-                1.0f, 0.2f, 0.2f);
             m_bulletModel->Draw(m_shaderProgram);
-        } 
-
-        else if (projectile.type == ProjectileType::LASER) {
-            glUseProgram(m_laserShaderProgram);
-
-            // Bind VAO and VBO
-            glBindVertexArray(dummyVAO);
-            glBindBuffer(GL_ARRAY_BUFFER, dummyVBO);
-
-            // Update vertex data
-            float laserLength = projectile.speed * projectile.lifetime;
-            glm::vec3 vertices[] = {
-                projectile.position,
-                projectile.position,
-                projectile.position + projectile.direction * laserLength,
-                projectile.position + projectile.direction * laserLength
-            };
-            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+        }
+    }
 
-            // Set uniforms using dedicated locations
-            glm::mat4 viewProj = m_projection * m_camera.GetViewMatrix();
-            glm::vec3 cameraRight = glm::normalize(glm::cross(m_camera.m_front, m_camera.m_up));
-            glUniformMatrix4fv(m_locLaserViewProj, 1, GL_FALSE, glm::value_ptr(viewProj));
-            glUniform3fv(m_locLaserCameraRight, 1, glm::value_ptr(cameraRight));
-            glUniform3f(m_locLaserColor, 1.0f, 0.1f, 0.05f);
-            glUniform1f(m_locLaserThickness, 0.5f);
-            glUniform1f(m_locLaserAlphaFalloff, 1.0f);
-            
-            // Draw
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            glDisable(GL_DEPTH_TEST);
+    // One quad per lit beam
+    bool anyBeam = false;
+    for (const Player& player : m_players) {
+        if (player.IsAlive() && player.m_beam.IsActive()) anyBeam = true;
+    }
+    if (anyBeam) {
+        glUseProgram(m_laserShaderProgram);
+
+        // Bind VAO and VBO
+        glBindVertexArray(dummyVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, dummyVBO);
+
+        // Set uniforms using dedicated locations
+        glm::mat4 viewProj = m_projection * m_camera.GetViewMatrix();
+        glm::vec3 cameraRight = glm::normalize(glm::cross(m_camera.m_front, m_camera.m_up));
+        glUniformMatrix4fv(m_locLaserViewProj, 1, GL_FALSE, glm::value_ptr(viewProj));
+        glUniform3fv(m_locLaserCameraRight, 1, glm::value_ptr(cameraRight));
+        glUniform3f(m_locLaserColor, 1.0f, 0.1f, 0.05f);
+        glUniform1f(m_locLaserThickness, 0.5f);
+        glUniform1f(m_locLaserAlphaFalloff, 1.0f);
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDisable(GL_DEPTH_TEST);
+        for (const Player& player : m_players) {
+            if (!player.IsAlive() || !player.m_beam.IsActive()) continue;
+            glm::vec3 start = player.m_beam.GetStart();
+            glm::vec3 end = player.m_beam.GetEnd();
+            glm::vec3 vertices[] = {start, start, end, end};
+            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
             glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-            // Cleanup
-            glDisable(GL_BLEND);
-            glEnable(GL_DEPTH_TEST);
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
-            glBindVertexArray(0);
         }
 
-        if (projectile.type == ProjectileType::EXPLOSIVE) {
-            glUseProgram(m_shaderProgram);
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), projectile.position);
+        // Cleanup
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    const ProjectileBatch& explosives = m_projectiles.GetBatch(ProjectileType::EXPLOSIVE);
+    if (explosives.Size() > 0) {
+        glUseProgram(m_shaderProgram);
+        glUniform3f(glGetUniformLocation(m_shaderProgram, "objectColor"), 
+            0.8f, 0.0f, 0.8f);
+        for (size_t i = 0; i < explosives.Size(); i++) {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), explosives.GetPosition(i));
             model = glm::scale(model, glm::vec3(0.14f));
             glUniformMatrix4fv(glGetUniformLocation(m_shaderProgram, "model"), 
                 1, GL_FALSE, &model[0][0]);
-            glUniform3f(glGetUniformLocation(m_shaderProgram, "objectColor"), 
-                0.8f, 0.0f, 0.8f);
             m_explosiveRoundModel->Draw(m_shaderProgram);
-        } 
+        }
     }
 }
 
@@ -5,25 +5,26 @@
 #include <glm/glm.hpp>
 #include "Camera.hpp"
 #include "Font.hpp"
+#include "HeightfieldRenderer.hpp"
 #include "Model.hpp"
 #include "Particles.hpp"
 #include "Player.hpp"
 #include "Projectile.hpp"
+#include "ShipGrid.hpp"
+#include "Terrain.hpp"
+#include "TerrainGenerator.hpp"
+#include "TerrainLOD.hpp"
+#include "TerrainProxy.hpp"
+#include "TerrainWorld.hpp"
+#include "ThreadPool.hpp"
+#include <array>
 #include <vector>
 #include <unordered_map>
-#include <mutex>
+#include <atomic>
+#include <memory>
 #include <functional>
-
-namespace std {
-    template <>
-    struct hash<std::pair<int, int>> {
-        size_t operator()(const std::pair<int, int>& p) const {
-            return hash<int>()(p.first) ^ (hash<int>()(p.second) << 1);
-        }
-    };
-}
-
-class Projectile;
+#include <chrono>
+#include <future>
 
 class Game {
 public:
@@ -33,6 +34,7 @@ public:
     float debugUpdateTimer = 0.0f; 
     float DEBUG_UPDATE_INTERVAL = 3.0f;
     static constexpr float MAP_BOUNDARY = 100.0f;
+    static constexpr const char* MAP_PATH = "assets/maps/map1.obj";
 
     // Settings
     float m_mouseSensitivity = 0.25f;
@@ -43,6 +45,29 @@ public:
     float m_renderDistance = 600.0f;
     bool m_hideHud = 0;
     bool m_nightMode = 0;
+    float m_heightfieldResolution = 4.0f; // Samples per world unit
+    float m_terrainLodError = 2.0f;       // Max screen-space error in pixels, 0 disables terrain LOD
+    bool m_terrainVertexPulling = 1;      // Draw the map from a height texture, takes precedence over the LOD
+    std::string m_worldPath;              // Streamed world directory, empty plays the single map
+    int m_worldMemoryBudgetMB = 256;
+    float m_worldStreamRadius = 300.0f;
+    uint32_t m_terrainSeed = 0;           // Non-zero generates the map from this seed instead of MAP_PATH
+    int m_terrainResolution = 256;        // Generated samples along each edge
+    float m_terrainSize = 200.0f;         // Generated map edge in world units, the playable area follows it
+    bool m_terrainGeneratorBenchmark = 0;
+    float m_collisionTolerance = 0.05f;   // Max distance the collision proxy may stray from the map, 0 collides with the render mesh
+    bool m_collisionProxyBenchmark = 0;
+    bool m_terrainQueryBenchmark = 0;     // Compare grid and heightfield queries at load
+    bool m_terrainSamplingBenchmark = 0;  // Time separate against fused height and normal lookups at load
+    int m_projectileCapacity = 1024;      // Live projectiles per type, spawns past it are dropped
+    bool m_explosionOcclusion = 1;        // Terrain between a blast and a ship blocks its damage
+
+    // Terrain queries
+    enum class TerrainQueryMode {
+        HEIGHTFIELD,    // Baked bilinear lookup
+        GRID,           // Reference ray casts against the spatial grid
+    };
+    TerrainQueryMode m_terrainQueryMode = TerrainQueryMode::HEIGHTFIELD;
 
     // Gamestates
     enum class GameState {
@@ -63,11 +88,27 @@ public:
     // Entities
     std::vector<Player> m_players;
     size_t m_mainPlayerIndex = 0;
-    std::vector<Projectile> m_projectiles;
+    uint32_t m_playerGeneration = 0;
+    // Broadphase for projectile hits, rebuilt after the ships move each frame
+    ShipGrid m_shipGrid;
+    static constexpr float SHIP_GRID_CELL_SIZE = 4.0f;
+    ProjectileStore m_projectiles;
 
     // Getters
     std::vector<Player>& GetPlayers() { return m_players; }
+    PlayerHandle GetPlayerHandle(const Player& player) const;
+    // nullptr once the player has been removed or its slot refilled
+    Player* ResolvePlayer(PlayerHandle handle);
+    // Spawns straight into the projectile pool, invalid handle when the type is at capacity
+    ProjectileHandle SpawnProjectile(const glm::vec3& position, const glm::vec3& direction, ProjectileType type,
+        float damage, const Player& source);
+    size_t SpawnVolley(const glm::vec3* positions, const glm::vec3* directions, size_t count, ProjectileType type,
+        float damage, const Player& source);
     Particles& GetParticles() { return m_particles; }
+    const ShipGrid& GetShipGrid() const { return m_shipGrid; }
+    Model* GetShipModel(ShipType type) const { return m_shipModels[static_cast<size_t>(type)]; }
+    // Applies damage and shows the hitmarker when the main player dealt it
+    void DamagePlayer(Player& target, float damage, PlayerHandle source);
 
     // Initilizers
     Game(GLFWwindow* window);
@@ -77,20 +118,58 @@ public:
     bool LoadModels();
     bool LoadTextures();
     bool LoadFonts();
+    // Waits for the background terrain bake, then builds everything that needs it
+    bool FinishLoadingTerrain();
     bool LoadPlacements();
 
     bool LoadPersistentSettings();
     bool SavePersistentSettings();
 
-    void GenerateHeightmap(const Model& terrainModel);
+    // Starts loading the baked collision data from the cache next to sourcePath, or building
+    // and caching it, on a background thread. FinishHeightmap waits and publishes the result.
+    void GenerateHeightmap(const Model& terrainModel, const std::string& sourcePath);
+    void FinishHeightmap();
+    // Opens m_worldPath with a builder that bakes and caches tiles like the map
+    bool OpenWorld();
+    // Procedural map from m_terrainSeed, sized to the playable area
+    Model* GenerateTerrainModel();
+    static std::vector<TerrainTriangle> ExtractTerrainTriangles(const Model& terrainModel);
+    // Read-only on Game, safe to call from worker threads
+    std::unique_ptr<TerrainCollision> BuildTerrainCollision(std::vector<TerrainTriangle> triangles,
+        float cellSize, bool verbose);
+    // Collision-only simplification of the render triangles within m_collisionTolerance
+    std::vector<TerrainTriangle> BuildCollisionProxy(std::vector<TerrainTriangle> triangles, bool verbose) const;
+    // The height texture and LOD draw the render mesh, not the proxy
+    void BakeRenderHeightfield(const std::vector<TerrainTriangle>& triangles);
+    // Memory, query times and height error of the proxy against full-detail collision
+    void CompareCollisionProxy(const std::vector<TerrainTriangle>& renderTriangles, const TerrainCollision& proxy,
+        float cellSize, int sampleCount);
+    void CompareTerrainQueryModes(int sampleCount) const;
     float GetTerrainHeight(float x, float z) const;
     float GetHeightFromMap(float x, float z) const;
+    float GetHeightFromGrid(float x, float z) const;
+    // Batched GetTerrainHeight: out[i] is the height under xz[i]
+    void QueryTerrainHeights(const glm::vec2* xz, float* out, size_t count) const;
     glm::vec3 GetTerrainNormal(float x, float z) const;
-    struct Triangle {
-        glm::vec3 v0, v1, v2;
-        glm::vec3 normal;
-    };
-    bool IsPointInTriangleXZ(const glm::vec2& point, const Triangle& tri) const;
+    // Height, normal and triangle id in one lookup
+    TerrainSample SampleTerrain(float x, float z) const;
+    void BenchmarkTerrainSampling(int sampleCount) const;
+    // Cheap min/max pyramid test for a sphere swept from -> to, counted in the debug stats
+    bool IsAboveTerrain(const glm::vec3& from, const glm::vec3& to, float radius) const;
+    bool RaycastTerrain(const glm::vec3& origin, const glm::vec3& dir, float maxDist, TerrainHit& hit) const;
+    bool SweepSphereTerrain(const glm::vec3& from, const glm::vec3& to, float radius, TerrainHit& hit) const;
+    bool HasLineOfSight(const glm::vec3& from, const glm::vec3& to) const;
+    const TerrainCollision* GetTerrainCollision() const { return m_terrainCollision.load(std::memory_order_acquire); }
+    // Collision under (x, z): the streamed tile when a world is open, else the map. May be null.
+    const TerrainCollision* GetTerrainAt(float x, float z) const;
+    // True where a world tile exists but hasn't streamed in, callers that can't wait treat it as solid
+    bool IsTerrainStreaming(float x, float z) const { return m_world.IsStreaming(x, z); }
+    float GetMapBoundary() const {
+        if (m_world.IsActive()) return m_world.GetBoundary();
+        return m_terrainSeed != 0 ? 0.5f * m_terrainSize : MAP_BOUNDARY;
+    }
+    void ReclaimTerrainSnapshots();
+    using Triangle = TerrainTriangle;
 
     // Updaters
     void ProcessMouseInput();
@@ -111,6 +190,8 @@ public:
     void ReportPlayerKilled() { m_lastKillTime = m_totalTime; }
     void ReportPlayerHit() { m_lastHitTime = m_totalTime; }
     void HandleEntityDestruction();
+    // Sun position, colour and camera for the model shader
+    void SetLighting(const glm::vec3& lightColor);
 
     void DebugOutput(float deltaTime);
 
@@ -121,7 +202,8 @@ public:
    
     void RenderPlaying();
     void Render3D();
-    void RenderMap();
+    void RenderMap(const glm::mat4& view, const glm::mat4& projection);
+    void UseTerrainShader(unsigned int program, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection);
     void RenderEntities();
     void RenderPlayers();
     void RenderProjectiles();
@@ -166,6 +248,8 @@ private:
 
     // Shader programs
     unsigned int m_shaderProgram;
+    unsigned int m_heightfieldShaderProgram;
+    unsigned int m_terrainShaderProgram;
     unsigned int m_particleShaderProgram;
     unsigned int m_laserShaderProgram;
     unsigned int m_hudShaderProgram;
@@ -174,12 +258,23 @@ private:
 
     // Models
     Model* m_spaceshipModel;
-    Model* m_mapModel;
+    Model* m_mapModel = nullptr;        // Null while a streamed world stands in for the map
+    static constexpr float MAP_CHUNK_SIZE = 16.0f;
+    std::vector<unsigned int> m_visibleMapChunks;
+    unsigned int m_visibleMapChunkCount = 0;
+    unsigned int m_culledMapChunkCount = 0;
+    static constexpr float TERRAIN_LOD_VERTEX_SPACING = 0.5f;
+    TerrainLOD m_terrainLOD;
+    HeightfieldRenderer m_heightfieldRenderer;
+    // Full-detail heights for drawing while collision runs on the proxy, empty otherwise
+    Heightfield m_renderHeightfield;
     Model* m_sunModel;
     glm::vec3 m_sunPosition;
+    glm::vec3 m_lightColor{1.0f};   // Last colour given to the model shader, other terrain shaders copy it
     Model* m_enemyModel;
     Model* m_bulletModel;
     Model* m_explosiveRoundModel;
+    std::array<Model*, SHIP_TYPE_COUNT> m_shipModels{};    // Indexed by ShipType
 
     FontLoader* m_font;
 
@@ -205,9 +300,36 @@ private:
     const float HITMARKER_DURATION = 0.5f;
     const float KILLMARKER_DURATION = 1.0f;
 
-    float m_gridCellSize = 0.5f;
-    mutable std::mutex m_spatialGridMutex;
-    std::unordered_map<std::pair<int, int>, std::vector<Triangle>> m_spatialGrid;
+    // Terrain collision snapshots. Readers load the current pointer once and
+    // never block; older snapshots stay alive until ReclaimTerrainSnapshots.
+    float m_gridCellSize = 0.75f;
+    std::atomic<const TerrainCollision*> m_terrainCollision{nullptr};
+    std::vector<std::unique_ptr<TerrainCollision>> m_terrainSnapshots;
+
+    // Workers for terrain generation and world streaming
+    ThreadPool m_threadPool;
+    // Streamed world, queries are main thread only
+    TerrainWorld m_world;
+    std::vector<glm::vec3> m_worldAnchors;  // Per-frame scratch
+    // Background collision bake, declared after the pool so it finishes before the workers stop
+    std::future<std::unique_ptr<TerrainCollision>> m_terrainBake;
+    std::chrono::high_resolution_clock::time_point m_terrainBakeStart;
+
+    // Visits every terrain snapshot a sphere swept from -> to can touch
+    template <typename F>
+    void ForEachTerrainAlong(const glm::vec3& from, const glm::vec3& to, float radius, F&& visit) const {
+        if (!m_world.IsActive()) {
+            if (const TerrainCollision* terrain = GetTerrainCollision()) visit(*terrain);
+            return;
+        }
+        glm::vec3 sweepMin = glm::min(from, to) - glm::vec3(radius);
+        glm::vec3 sweepMax = glm::max(from, to) + glm::vec3(radius);
+        m_world.ForEachCollision(glm::vec2(sweepMin.x, sweepMin.z), glm::vec2(sweepMax.x, sweepMax.z), visit);
+    }
+
+    // Altitude early-out statistics, reset with every debug print
+    mutable std::atomic<uint64_t> m_terrainChecks{0};
+    mutable std::atomic<uint64_t> m_terrainEarlyOuts{0};
 
     Particles m_particles;
 
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+
+// Slot index plus the generation the slot had when the handle was taken.
+// Freeing or refilling a slot bumps its generation, so a kept handle stops
+// resolving instead of pointing at whatever lives there now.
+template <typename T>
+struct Handle {
+    static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+    uint32_t index = INVALID_INDEX;
+    uint32_t generation = 0;
+
+    bool IsValid() const { return index != INVALID_INDEX; }
+    bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+class Player;
+struct ProjectileSlot;
+using PlayerHandle = Handle<Player>;
+using ProjectileHandle = Handle<ProjectileSlot>;
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "HeightfieldRenderer.hpp"
+#include "Camera.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+static constexpr int PATCH_VERTS = HeightfieldRenderer::PATCH_QUADS + 1;
+
+bool HeightfieldRenderer::Build(const Heightfield& heightfield, float vertexSpacing) {
+    Release();
+    if (heightfield.IsEmpty() || vertexSpacing <= 0.0f) return false;
+
+    // Resample at the render spacing, the last texel lands on the far edge.
+    // Texels the bake did not cover stay NO_TERRAIN and the shader drops their triangles
+    const glm::vec2 minBounds = heightfield.GetMinBounds();
+    const glm::vec2 maxBounds = heightfield.GetMaxBounds();
+    m_width = static_cast<int>(std::ceil((maxBounds.x - minBounds.x) / vertexSpacing)) + 1;
+    m_depth = static_cast<int>(std::ceil((maxBounds.y - minBounds.y) / vertexSpacing)) + 1;
+    m_origin = minBounds;
+    m_spacing = vertexSpacing;
+
+    std::vector<float> heights(static_cast<size_t>(m_width) * m_depth);
+    for (int z = 0; z < m_depth; z++) {
+        for (int x = 0; x < m_width; x++) {
+            float px = std::min(minBounds.x + x * vertexSpacing, maxBounds.x);
+            float pz = std::min(minBounds.y + z * vertexSpacing, maxBounds.y);
+            heights[static_cast<size_t>(z) * m_width + x] = heightfield.GetCoveredHeight(px, pz);
+        }
+    }
+
+    // Patch bounds for culling over the covered texels, texels past the edge clamp like the shader does
+    const int patchesX = (m_width - 1 + PATCH_QUADS - 1) / PATCH_QUADS;
+    const int patchesZ = (m_depth - 1 + PATCH_QUADS - 1) / PATCH_QUADS;
+    for (int patchZ = 0; patchZ < patchesZ; patchZ++) {
+        for (int patchX = 0; patchX < patchesX; patchX++) {
+            Patch patch;
+            patch.origin = glm::vec2(patchX * PATCH_QUADS, patchZ * PATCH_QUADS);
+            const int endX = std::min((patchX + 1) * PATCH_QUADS, m_width - 1);
+            const int endZ = std::min((patchZ + 1) * PATCH_QUADS, m_depth - 1);
+            float minHeight = FLT_MAX, maxHeight = -FLT_MAX;
+            for (int z = patchZ * PATCH_QUADS; z <= endZ; z++) {
+                for (int x = patchX * PATCH_QUADS; x <= endX; x++) {
+                    float h = heights[static_cast<size_t>(z) * m_width + x];
+                    if (h == Heightfield::NO_TERRAIN) continue;
+                    minHeight = std::min(minHeight, h);
+                    maxHeight = std::max(maxHeight, h);
+                }
+            }
+            // Nothing under this patch would survive the shader
+            if (minHeight > maxHeight) continue;
+            patch.boundsMin = glm::vec3(m_origin.x + patch.origin.x * m_spacing, minHeight, m_origin.y + patch.origin.y * m_spacing);
+            patch.boundsMax = glm::vec3(m_origin.x + endX * m_spacing, maxHeight, m_origin.y + endZ * m_spacing);
+            m_patches.push_back(patch);
+        }
+    }
+    if (m_patches.empty()) return false;
+
+    glGenTextures(1, &m_heightTexture);
+    glBindTexture(GL_TEXTURE_2D, m_heightTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, m_width, m_depth, 0, GL_RED, GL_FLOAT, heights.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // The shared patch: texel offsets as bytes, same a-c-b / b-c-d split as the LOD tiles
+    std::vector<GLubyte> gridVertices;
+    gridVertices.reserve(PATCH_VERTS * PATCH_VERTS * 2);
+    for (int z = 0; z < PATCH_VERTS; z++) {
+        for (int x = 0; x < PATCH_VERTS; x++) {
+            gridVertices.push_back(static_cast<GLubyte>(x));
+            gridVertices.push_back(static_cast<GLubyte>(z));
+        }
+    }
+    std::vector<GLushort> indices;
+    indices.reserve(PATCH_QUADS * PATCH_QUADS * 6);
+    for (int z = 0; z < PATCH_QUADS; z++) {
+        for (int x = 0; x < PATCH_QUADS; x++) {
+            GLushort a = static_cast<GLushort>(z * PATCH_VERTS + x);
+            GLushort b = a + 1;
+            GLushort c = a + PATCH_VERTS;
+            GLushort d = c + 1;
+            indices.insert(indices.end(), {a, c, b, b, c, d});
+        }
+    }
+    m_patchIndexCount = static_cast<GLsizei>(indices.size());
+
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_patchVBO);
+    glGenBuffers(1, &m_instanceVBO);
+    glGenBuffers(1, &m_EBO);
+    glBindVertexArray(m_VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_patchVBO);
+    glBufferData(GL_ARRAY_BUFFER, gridVertices.size(), gridVertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_UNSIGNED_BYTE, GL_FALSE, 2 * sizeof(GLubyte), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // Patch origins, one per instance, refilled every frame with the visible patches
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, m_patches.size() * sizeof(glm::vec2), nullptr, GL_STREAM_DRAW);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+    return true;
+}
+
+void HeightfieldRenderer::Release() {
+    if (m_heightTexture) glDeleteTextures(1, &m_heightTexture);
+    if (m_VAO) glDeleteVertexArrays(1, &m_VAO);
+    if (m_patchVBO) glDeleteBuffers(1, &m_patchVBO);
+    if (m_instanceVBO) glDeleteBuffers(1, &m_instanceVBO);
+    if (m_EBO) glDeleteBuffers(1, &m_EBO);
+    m_heightTexture = m_VAO = m_patchVBO = m_instanceVBO = m_EBO = 0;
+    m_width = m_depth = 0;
+    m_patches.clear();
+}
+
+void HeightfieldRenderer::Draw(GLuint shaderProgram, const glm::mat4& view, const glm::mat4& projection,
+    const glm::vec3& offset, float renderDistance) {
+    m_stats = {};
+    if (m_patches.empty()) return;
+
+    const Frustum frustum = Frustum::FromMatrix(projection * view);
+    const glm::vec3 eye = glm::vec3(glm::inverse(view)[3]);
+    m_visiblePatches.clear();
+    for (const Patch& patch : m_patches) {
+        glm::vec3 boundsMin = patch.boundsMin + offset;
+        glm::vec3 boundsMax = patch.boundsMax + offset;
+        if (glm::length(glm::clamp(eye, boundsMin, boundsMax) - eye) > renderDistance ||
+            !frustum.IntersectsAABB(boundsMin, boundsMax)) {
+            m_stats.culledPatches++;
+            continue;
+        }
+        m_visiblePatches.push_back(patch.origin);
+    }
+    m_stats.patches = static_cast<unsigned int>(m_visiblePatches.size());
+    m_stats.triangles = m_stats.patches * PATCH_QUADS * PATCH_QUADS * 2;
+    if (m_visiblePatches.empty()) return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, m_visiblePatches.size() * sizeof(glm::vec2), m_visiblePatches.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_heightTexture);
+    glUniform1i(glGetUniformLocation(shaderProgram, "heightMap"), 0);
+    glUniform2f(glGetUniformLocation(shaderProgram, "terrainOrigin"), m_origin.x, m_origin.y);
+    glUniform1f(glGetUniformLocation(shaderProgram, "terrainSpacing"), m_spacing);
+
+    // Every visible patch in one call
+    glBindVertexArray(m_VAO);
+    glDrawElementsInstanced(GL_TRIANGLES, m_patchIndexCount, GL_UNSIGNED_SHORT, 0,
+        static_cast<GLsizei>(m_visiblePatches.size()));
+    glBindVertexArray(0);
+}
+
+size_t HeightfieldRenderer::GetMemoryUsage() const {
+    return static_cast<size_t>(m_width) * m_depth * sizeof(float) +
+           PATCH_VERTS * PATCH_VERTS * 2 * sizeof(GLubyte) +
+           static_cast<size_t>(m_patchIndexCount) * sizeof(GLushort) +
+           m_patches.size() * sizeof(glm::vec2);
+}
+
+size_t HeightfieldRenderer::GetEquivalentMeshMemory() const {
+    // Position, color and normal per vertex plus 32-bit indices, as the OBJ path uploads them
+    const size_t vertexCount = static_cast<size_t>(m_width) * m_depth;
+    const size_t quadCount = static_cast<size_t>(m_width - 1) * (m_depth - 1);
+    return vertexCount * 9 * sizeof(float) + quadCount * 6 * sizeof(unsigned int);
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "Terrain.hpp"
+
+// Draws a heightfield from a single R32F texture. One small grid patch is
+// instanced over the map and the vertex shader pulls heights and normals from
+// the texture, so the terrain needs no per-vertex buffers at all.
+class HeightfieldRenderer {
+public:
+    static constexpr int PATCH_QUADS = 32;      // Quads along a patch edge
+
+    struct FrameStats {
+        unsigned int patches;
+        unsigned int culledPatches;
+        unsigned int triangles;
+    };
+
+    HeightfieldRenderer() = default;
+    ~HeightfieldRenderer() { Release(); }
+    // Owns GL objects, a copy would delete them twice
+    HeightfieldRenderer(const HeightfieldRenderer&) = delete;
+    HeightfieldRenderer& operator=(const HeightfieldRenderer&) = delete;
+
+    // vertexSpacing is the distance between texels in world units
+    bool Build(const Heightfield& heightfield, float vertexSpacing);
+    void Release();
+
+    // Expects the heightfield shader to be bound with its model matrix set to offset
+    void Draw(GLuint shaderProgram, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& offset,
+        float renderDistance);
+
+    bool IsEmpty() const { return m_patches.empty(); }
+    int GetWidth() const { return m_width; }
+    int GetDepth() const { return m_depth; }
+    size_t GetPatchCount() const { return m_patches.size(); }
+    // Texture plus patch buffers, against the interleaved indexed mesh the same grid would need
+    size_t GetMemoryUsage() const;
+    size_t GetEquivalentMeshMemory() const;
+    const FrameStats& GetFrameStats() const { return m_stats; }
+
+private:
+    struct Patch {
+        glm::vec2 origin;               // First texel of the patch
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+    };
+
+    GLuint m_heightTexture = 0;
+    GLuint m_VAO = 0, m_patchVBO = 0, m_instanceVBO = 0, m_EBO = 0;
+    GLsizei m_patchIndexCount = 0;
+    int m_width = 0;
+    int m_depth = 0;
+    glm::vec2 m_origin{0.0f};
+    float m_spacing = 1.0f;
+    std::vector<Patch> m_patches;
+    std::vector<glm::vec2> m_visiblePatches;   // Per-frame instance data
+    FrameStats m_stats = {};
+};
\ No newline at end of file
@@ -2,6 +2,9 @@
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <glad/glad.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 #include <iostream>
 
 Model::Model(const std::string& path) {
@@ -20,6 +23,12 @@ Model::Model(const std::string& path) {
     processNode(scene->mRootNode, scene);
 }
 
+Model::Model(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals,
+    const std::vector<unsigned int>& indices) {
+    std::vector<glm::vec3> colors(positions.size(), glm::vec3(0.7f));
+    meshes.push_back(createMesh(positions, colors, normals, indices));
+}
+
 void Model::Draw(unsigned int shaderProgram) {
     for(const auto& mesh : meshes) {
         glBindVertexArray(mesh.VAO);
@@ -27,6 +36,107 @@ void Model::Draw(unsigned int shaderProgram) {
     }
 }
 
+void Model::BuildChunks(float chunkSize) {
+    chunks.clear();
+    if (chunkSize <= 0.0f) return;
+
+    for (unsigned int meshIndex = 0; meshIndex < meshes.size(); meshIndex++) {
+        Mesh& mesh = meshes[meshIndex];
+        const unsigned int triangleCount = static_cast<unsigned int>(mesh.indices.size() / 3);
+        if (triangleCount == 0) continue;
+
+        auto position = [&](unsigned int index) { return vertices[mesh.baseVertex + index]; };
+
+        // Chunk grid over the mesh's XZ bounds, triangles go to the cell under their centroid
+        glm::vec2 minXZ(FLT_MAX), maxXZ(-FLT_MAX);
+        for (unsigned int index : mesh.indices) {
+            glm::vec3 p = position(index);
+            minXZ = glm::min(minXZ, glm::vec2(p.x, p.z));
+            maxXZ = glm::max(maxXZ, glm::vec2(p.x, p.z));
+        }
+        const int cellsX = static_cast<int>(std::floor((maxXZ.x - minXZ.x) / chunkSize)) + 1;
+        const int cellsZ = static_cast<int>(std::floor((maxXZ.y - minXZ.y) / chunkSize)) + 1;
+
+        std::vector<unsigned int> triangleCell(triangleCount);
+        std::vector<unsigned int> cellStart(static_cast<size_t>(cellsX) * cellsZ + 1, 0);
+        for (unsigned int t = 0; t < triangleCount; t++) {
+            glm::vec3 centroid = (position(mesh.indices[t * 3]) + position(mesh.indices[t * 3 + 1]) +
+                                  position(mesh.indices[t * 3 + 2])) / 3.0f;
+            int x = std::clamp(static_cast<int>((centroid.x - minXZ.x) / chunkSize), 0, cellsX - 1);
+            int z = std::clamp(static_cast<int>((centroid.z - minXZ.y) / chunkSize), 0, cellsZ - 1);
+            triangleCell[t] = static_cast<unsigned int>(z * cellsX + x);
+            cellStart[triangleCell[t] + 1]++;
+        }
+        for (size_t c = 1; c < cellStart.size(); c++) {
+            cellStart[c] += cellStart[c - 1];
+        }
+
+        // Scatter triangles into cell order
+        std::vector<unsigned int> sorted(mesh.indices.size());
+        std::vector<unsigned int> cursor(cellStart.begin(), cellStart.end() - 1);
+        for (unsigned int t = 0; t < triangleCount; t++) {
+            unsigned int dst = cursor[triangleCell[t]]++ * 3;
+            sorted[dst] = mesh.indices[t * 3];
+            sorted[dst + 1] = mesh.indices[t * 3 + 1];
+            sorted[dst + 2] = mesh.indices[t * 3 + 2];
+        }
+        mesh.indices.swap(sorted);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, mesh.indices.size() * sizeof(unsigned int), mesh.indices.data());
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        for (size_t c = 0; c + 1 < cellStart.size(); c++) {
+            if (cellStart[c] == cellStart[c + 1]) continue;
+
+            Chunk chunk;
+            chunk.mesh = meshIndex;
+            chunk.firstIndex = cellStart[c] * 3;
+            chunk.indexCount = (cellStart[c + 1] - cellStart[c]) * 3;
+            chunk.boundsMin = glm::vec3(FLT_MAX);
+            chunk.boundsMax = glm::vec3(-FLT_MAX);
+            for (unsigned int i = chunk.firstIndex; i < chunk.firstIndex + chunk.indexCount; i++) {
+                chunk.boundsMin = glm::min(chunk.boundsMin, position(mesh.indices[i]));
+                chunk.boundsMax = glm::max(chunk.boundsMax, position(mesh.indices[i]));
+            }
+            chunks.push_back(chunk);
+        }
+    }
+}
+
+void Model::ReleaseBuffers() {
+    for (Mesh& mesh : meshes) {
+        glDeleteVertexArrays(1, &mesh.VAO);
+        glDeleteBuffers(1, &mesh.VBO);
+        glDeleteBuffers(1, &mesh.EBO);
+        mesh.VAO = mesh.VBO = mesh.EBO = 0;
+        mesh.indexCount = 0;
+    }
+    chunks.clear();
+}
+
+void Model::DrawChunks(const std::vector<unsigned int>& chunkIndices) const {
+    size_t i = 0;
+    while (i < chunkIndices.size()) {
+        const Chunk& first = chunks[chunkIndices[i]];
+        unsigned int indexCount = first.indexCount;
+
+        // Extend the draw while the next chunk starts where this range ends
+        size_t next = i + 1;
+        while (next < chunkIndices.size()) {
+            const Chunk& chunk = chunks[chunkIndices[next]];
+            if (chunk.mesh != first.mesh || chunk.firstIndex != first.firstIndex + indexCount) break;
+            indexCount += chunk.indexCount;
+            next++;
+        }
+
+        glBindVertexArray(meshes[first.mesh].VAO);
+        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT,
+            reinterpret_cast<const void*>(static_cast<size_t>(first.firstIndex) * sizeof(unsigned int)));
+        i = next;
+    }
+}
+
 void Model::processNode(aiNode* node, const aiScene* scene) {
     // Process all meshes in node
     for(unsigned int i = 0; i < node->mNumMeshes; i++) {
@@ -74,7 +184,6 @@ Model::Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) {
         // Default color (will be overridden in Game.cpp)
         colors.push_back(glm::vec3(0.7f));
     }
-    this->vertices.insert(this->vertices.end(), vertices.begin(), vertices.end());
 
     // Process indices
     for(unsigned int i = 0; i < mesh->mNumFaces; i++) {
@@ -84,6 +193,14 @@ Model::Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) {
         }
     }
 
+    return createMesh(vertices, colors, normals, indices);
+}
+
+Model::Mesh Model::createMesh(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& colors,
+    const std::vector<glm::vec3>& normals, const std::vector<unsigned int>& indices) {
+    const unsigned int baseVertex = static_cast<unsigned int>(this->vertices.size());
+    this->vertices.insert(this->vertices.end(), vertices.begin(), vertices.end());
+
     // Setup OpenGL buffers
     unsigned int VAO, VBO, EBO;
     glGenVertexArrays(1, &VAO);
@@ -135,5 +252,5 @@ Model::Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) {
 
     glBindVertexArray(0);
 
-    return {VAO, VBO, EBO, static_cast<unsigned int>(indices.size()), indices};
+    return {VAO, VBO, EBO, static_cast<unsigned int>(indices.size()), indices, baseVertex};
 }
\ No newline at end of file
@@ -7,23 +7,47 @@
 class Model {
 public:
     Model(const std::string& path);
+    // Single mesh from generated geometry, e.g. procedural terrain
+    Model(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals,
+        const std::vector<unsigned int>& indices);
     void Draw(unsigned int shaderProgram);
 
     struct Mesh {
         unsigned int VAO, VBO, EBO;
         unsigned int indexCount;
         std::vector<unsigned int> indices;
+        unsigned int baseVertex;        // Offset of this mesh's vertices in GetVertices()
     };
 
+    // Contiguous index range of one mesh covering a square XZ region
+    struct Chunk {
+        unsigned int mesh;
+        unsigned int firstIndex;
+        unsigned int indexCount;
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+    };
+
+    // Reorders every mesh's triangles so each chunkSize x chunkSize XZ cell is one index range
+    void BuildChunks(float chunkSize);
+    // Draws the given chunks, merging neighbours that are contiguous in the index buffer
+    void DrawChunks(const std::vector<unsigned int>& chunkIndices) const;
+    // Frees the GPU copy once another renderer draws this model, vertices and indices stay for collision
+    void ReleaseBuffers();
+    const std::vector<Chunk>& GetChunks() const { return chunks; }
+
     size_t GetMeshCount() const;
     const std::vector<glm::vec3>& GetVertices() const { return vertices;}
     const std::vector<Mesh>& Getmeshes() const { return meshes; }
     
 private:
     std::vector<Mesh> meshes;
+    std::vector<Chunk> chunks;
     std::vector<glm::vec3> vertices;
     std::string directory;
 
     void processNode(aiNode* node, const aiScene* scene);
     Mesh processMesh(aiMesh* mesh, const aiScene* scene);
+    Mesh createMesh(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& colors,
+        const std::vector<glm::vec3>& normals, const std::vector<unsigned int>& indices);
 };
\ No newline at end of file
@@ -10,11 +10,11 @@
 #include <glm/gtx/intersect.hpp>
 
 Player::Player() 
-    : position(glm::vec3(10.0f)), velocity(0.0f), rotation(glm::identity<glm::quat>()) {}
+    : position(glm::vec3(10.0f)), previousPosition(position), velocity(0.0f), rotation(glm::identity<glm::quat>()) {}
 
 void Player::InitializeStats() {
     // STATS
-    const auto& stats = SHIP_STATS.at(m_shipType);
+    const auto& stats = GetShipStats(m_shipType);
 
     maxHealth = stats.maxHealth;
     health = maxHealth;
@@ -33,8 +33,8 @@ void Player::InitializeStats() {
     collisionRadius = stats.collisionRadius;
 
     // ABILITIES
-    abilityCooldown1 = ABILITY_PARAMS.at(m_ability1).cooldown;
-    abilityCooldown2 = ABILITY_PARAMS.at(m_ability2).cooldown;
+    abilityCooldown1 = GetAbilityInfo(m_ability1).cooldown;
+    abilityCooldown2 = GetAbilityInfo(m_ability2).cooldown;
     m_timeSinceLastAbility1 = abilityCooldown1;
     m_timeSinceLastAbility2 = abilityCooldown1;
 }
@@ -44,7 +44,7 @@ float Player::GetRoll() const {
     return glm::degrees(euler.z);
 }
 
-void Player::ProcessKeyboardInput(GLFWwindow* window, float deltaTime) {
+void Player::ProcessKeyboardInput(GLFWwindow* window, float deltaTime, Game& game) {
     // Forward/backward movement
     glm::vec3 forward = GetForward();
     if(glfwGetKey(window, GLFW_KEY_W) && glm::length(velocity) < maxSpeed) 
@@ -62,10 +62,8 @@ void Player::ProcessKeyboardInput(GLFWwindow* window, float deltaTime) {
     );
     
     if (glfwGetKey(window, GLFW_KEY_SPACE) && m_timeSinceLastAbility2 >= abilityCooldown2) {
-        m_ability.Activate(m_ability2, *this);
+        m_ability.Activate(m_ability2, *this, game);
         m_timeSinceLastAbility2 = 0.0f;
-
-        m_ability.TransferProjectiles(m_projectiles);
     }
 }
 
@@ -107,10 +105,8 @@ void Player::ProcessMouseInput(GLFWwindow* window, float deltaTime, Game& game)
     }
 
     if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS && m_timeSinceLastAbility1 >= abilityCooldown1) {
-        m_ability.Activate(m_ability1, *this);
+        m_ability.Activate(m_ability1, *this, game);
         m_timeSinceLastAbility1 = 0;
-
-        m_ability.TransferProjectiles(m_projectiles);
     }
 }
 
@@ -118,7 +114,7 @@ void Player::Update(GLFWwindow* window, float deltaTime, Game& game) {
     if(!isMainPlayer) return;
     collisionDetected = false;
 
-    ProcessKeyboardInput(window, deltaTime);
+    ProcessKeyboardInput(window, deltaTime, game);
     ProcessMouseInput(window, deltaTime, game);
 
     UpdateRotation(window, deltaTime, m_reticleOffset);
@@ -194,7 +190,8 @@ void Player::UpdateAI(float deltaTime, const glm::vec3& targetPos, Game& game) {
         UpdateAIRotation(direction);
     }
     
-    if(distanceToTarget < AI_AGGRESSION_RANGE) {
+    // Don't waste shots into a ridge
+    if(distanceToTarget < AI_AGGRESSION_RANGE && game.HasLineOfSight(position, targetPos)) {
         AiShooting(deltaTime, direction, game);
     }
 
@@ -220,135 +217,44 @@ void Player::UpdateAIRotation(const glm::vec3& direction) {
 }
 
 void Player::Shoot(float deltaTime, Game& game) {
-    if (m_shipType == ShipType::XR9) {
-            const glm::vec3 right = GetRight();
-            const float SPAWN_OFFSET = 0.5f;
-
-            m_projectiles.emplace_back(
-                position + right * SPAWN_OFFSET + GetForward() * 1.0f,
-                GetForward(), 
-                projectileType,
-                baseDamage
-            );
-            m_projectiles.back().sourcePlayer = this;
-            
-            m_projectiles.emplace_back(
-                position - right * SPAWN_OFFSET + GetForward() * 1.0f,
-                GetForward(), 
-                projectileType,
-                baseDamage
-            );
-            m_projectiles.back().sourcePlayer = this;
-    }
-
-    else if(m_shipType == ShipType::HellFire) {
-        float SIDE_OFFSET = 0.3f;
-        float DEPTH_OFFSET = -5.0f;
-        float HEIGHT_OFFSET = -0.1f;
-        m_projectiles.emplace_back(
-            position + SIDE_OFFSET * GetRight() + DEPTH_OFFSET * GetForward() + HEIGHT_OFFSET * GetUp(),
-            GetForward(),
-            projectileType,
-            baseDamage
-        );
-        m_projectiles.back().sourcePlayer = this;
+    const ShipStats& stats = GetShipStats(m_shipType);
+    if (stats.muzzleCount == 0) return;
+
+    // One basis per shot, shared by every barrel
+    const glm::vec3 right = GetRight();
+    const glm::vec3 up = GetUp();
+    const glm::vec3 forward = GetForward();
+
+    // The laser is a beam carried by the ship, it only needs to know its barrel
+    if (projectileType == ProjectileType::LASER) {
+        const Muzzle& muzzle = stats.muzzles[0];
+        m_beam.Trigger(glm::vec3(muzzle.right, muzzle.up, muzzle.forward));
+        return;
     }
 
-        else if(m_shipType == ShipType::HYDRA) {
-            float SIDE_OFFSET = 0.45f;
-            float DEPTH_OFFSET = 0.0f;
-            float HEIGHT_OFFSET = -0.2f;
-            m_projectiles.emplace_back(
-                position + SIDE_OFFSET * GetRight() + DEPTH_OFFSET * GetForward() + HEIGHT_OFFSET * GetUp(),
-                GetForward(),
-                projectileType,
-                baseDamage
-            );
-            m_projectiles.back().sourcePlayer = this;
-
-            m_projectiles.emplace_back(
-                position - SIDE_OFFSET * GetRight() + DEPTH_OFFSET * GetForward() + HEIGHT_OFFSET * GetUp(),
-                GetForward(),
-                projectileType,
-                baseDamage
-            );
-            m_projectiles.back().sourcePlayer = this;
+    glm::vec3 positions[MAX_MUZZLES];
+    glm::vec3 directions[MAX_MUZZLES];
+    for (int i = 0; i < stats.muzzleCount; i++) {
+        const Muzzle& muzzle = stats.muzzles[i];
+        positions[i] = position + muzzle.right * right + muzzle.up * up + muzzle.forward * forward;
+        directions[i] = forward;
+        if (stats.spread > 0.0f) {
+            directions[i] += glm::linearRand(-stats.spread, stats.spread) * right +
+                glm::linearRand(-stats.spread, stats.spread) * up;
         }
+    }
+    game.SpawnVolley(positions, directions, stats.muzzleCount, projectileType, baseDamage, *this);
 }
 
 void Player::AiShooting(float deltaTime, const glm::vec3& targetDir, Game& game) {
-    const auto& stats = SHIP_STATS.at(m_shipType);
+    const auto& stats = GetShipStats(m_shipType);
     m_timeSinceLastShot += deltaTime;
 
     float effectiveFireRate = stats.fireRate * 1.1f;
     float randomDelay = glm::linearRand(0.0f, 0.15f);
     
     if(m_timeSinceLastShot >= (effectiveFireRate + randomDelay)) {
-        const glm::vec3 right = GetRight();
-        const float SPAWN_OFFSET = 0.5f;
-
-        // Add some inaccuracy to AI aiming
-        glm::vec3 inaccurateDir = targetDir;
-        inaccurateDir.x += glm::linearRand(-0.1f, 0.1f);
-        inaccurateDir.y += glm::linearRand(-0.1f, 0.1f);
-        inaccurateDir.z += glm::linearRand(-0.1f, 0.1f);
-        inaccurateDir = glm::normalize(inaccurateDir);
-
-        if (m_shipType == ShipType::XR9) {
-                const glm::vec3 right = GetRight();
-                const float SPAWN_OFFSET = 0.5f;
-
-                m_projectiles.emplace_back(
-                    position + right * SPAWN_OFFSET + GetForward() * 1.0f,
-                    GetForward(), 
-                    projectileType,
-                    baseDamage
-                );
-                m_projectiles.back().sourcePlayer = this;
-                
-                m_projectiles.emplace_back(
-                    position - right * SPAWN_OFFSET + GetForward() * 1.0f,
-                    GetForward(), 
-                    projectileType,
-                    baseDamage
-                );
-                m_projectiles.back().sourcePlayer = this;
-        }
-
-        else if(m_shipType == ShipType::HellFire) {
-            float SIDE_OFFSET = 0.3f;
-            float DEPTH_OFFSET = -5.0f;
-            float HEIGHT_OFFSET = -0.1f;
-            m_projectiles.emplace_back(
-                position + SIDE_OFFSET * GetRight() + DEPTH_OFFSET * GetForward() + HEIGHT_OFFSET * GetUp(),
-                GetForward(),
-                projectileType,
-                baseDamage
-            );
-            m_projectiles.back().sourcePlayer = this;
-        }
-
-        else if(m_shipType == ShipType::HYDRA) {
-            float SIDE_OFFSET = 0.45f;
-            float DEPTH_OFFSET = 0.0f;
-            float HEIGHT_OFFSET = -0.2f;
-            m_projectiles.emplace_back(
-                position + SIDE_OFFSET * GetRight() + DEPTH_OFFSET * GetForward() + HEIGHT_OFFSET * GetUp(),
-                GetForward(),
-                projectileType,
-                baseDamage
-            );
-            m_projectiles.back().sourcePlayer = this;
-
-            m_projectiles.emplace_back(
-                position - SIDE_OFFSET * GetRight() + DEPTH_OFFSET * GetForward() + HEIGHT_OFFSET * GetUp(),
-                GetForward(),
-                projectileType,
-                baseDamage
-            );
-            m_projectiles.back().sourcePlayer = this;
-        }
-        
+        Shoot(deltaTime, game);
         m_timeSinceLastShot = 0.0f;
     }
 }
@@ -383,40 +289,56 @@ bool Player::TakeDamage(float damage, Game& game) {
 }
 
 void Player::HandleCollisions(Game& game, const float deltaTime) {
-    const float terrainHeight = game.GetTerrainHeight(position.x, position.z);
-    const float verticalDist = position.y - terrainHeight;
+    const glm::vec3 prevPos = position - velocity * deltaTime;
 
-    if(verticalDist < collisionRadius) {
-        glm::vec3 normal = game.GetTerrainNormal(position.x, position.z);
-        
-        // Continuous collision detection
-        glm::vec3 prevPos = position - velocity * deltaTime;
-        for(int i = 0; i <= 5; i++) {
-            float t = i/5.0f;
-            glm::vec3 checkPos = glm::mix(prevPos, position, t);
-            float checkHeight = game.GetTerrainHeight(checkPos.x, checkPos.z);
-            
-            if(checkPos.y - checkHeight < collisionRadius and 
-            game.m_totalTime - m_lastCollisionTime > COLLISION_DAMAGE_COOLDOWN) {
-                m_lastCollisionTime = game.m_totalTime;   
-                position = checkPos;
-                position.y = checkHeight + collisionRadius;
-                
-                // Physics response
-                glm::vec3 velocityDir = glm::normalize(velocity);
-                glm::vec3 reflection = velocityDir - 2.0f * glm::dot(velocityDir, normal) * normal;
-                velocity = reflection * glm::length(velocity) * BOUNCE_FACTOR;
-                
-                // Friction
-                glm::vec3 tangentVel = velocity - glm::dot(velocity, normal) * normal;
-                velocity -= tangentVel * FRICTION_FACTOR;
-                
+    // Ground that hasn't streamed in yet is solid, the ship holds where it was until the tile arrives
+    if (game.IsTerrainStreaming(position.x, position.z)) {
+        position = prevPos;
+        velocity = glm::vec3(0.0f);
+        return;
+    }
+
+    // The cooldown only limits damage, the ship is always kept out of the terrain
+    const bool canTakeDamage = game.m_totalTime - m_lastCollisionTime > COLLISION_DAMAGE_COOLDOWN;
+
+    // Continuous collision detection, ships provably above the terrain skip the sweep
+    const bool nearTerrain = !game.IsAboveTerrain(prevPos, position, collisionRadius);
+    TerrainHit hit;
+    if(nearTerrain and game.SweepSphereTerrain(prevPos, position, collisionRadius, hit)) {
+        // Touching from the start the center may already be under the surface, where
+        // center - contact points down, so take the side from the triangle instead
+        const glm::vec3 normal = hit.time <= 0.0f ? hit.upNormal : hit.normal;
+
+        // Already touching but moving away is a ship leaving the ground, not an impact
+        if (hit.time > 0.0f || glm::dot(velocity, normal) < 0.0f) {
+            // Rest the hull just clear of the contact point so the next sweep doesn't start touching
+            position = hit.point + normal * (collisionRadius + COLLISION_SKIN);
+
+            // Physics response
+            glm::vec3 velocityDir = glm::normalize(velocity);
+            glm::vec3 reflection = velocityDir - 2.0f * glm::dot(velocityDir, normal) * normal;
+            velocity = reflection * glm::length(velocity) * BOUNCE_FACTOR;
+
+            // Friction
+            glm::vec3 tangentVel = velocity - glm::dot(velocity, normal) * normal;
+            velocity -= tangentVel * FRICTION_FACTOR;
+
+            if (canTakeDamage) {
+                m_lastCollisionTime = game.m_totalTime;
                 collisionDetected = true;
-                break;
             }
         }
     }
 
+    // A hull that ended up wholly under the surface never touches a triangle in the sweep, lift it back out
+    if (nearTerrain) {
+        const TerrainSample ground = game.SampleTerrain(position.x, position.z);
+        if (ground.height != Heightfield::NO_TERRAIN && position.y < ground.height + collisionRadius) {
+            position.y = ground.height + collisionRadius + COLLISION_SKIN;
+            velocity.y = std::max(velocity.y, 0.0f);
+        }
+    }
+
     const float boundary = MAP_BOUNDARY - collisionRadius;
     if(position.x > boundary || position.x < -boundary) {
         velocity.x = -velocity.x * BOUNCE_FACTOR;
@@ -1,5 +1,6 @@
 #pragma once
 #include "Ability.hpp"
+#include "Beam.hpp"
 #include "Ship.hpp"
 #include "Projectile.hpp"
 #include <vector>
@@ -18,12 +19,10 @@ private:
     glm::vec2 m_mouseDelta{0.0f, 0.0f};
     glm::vec2 m_reticleOffset{0.0f, 0.0f};
 
-    // Player's projectiles (to be transferred to the game)
-    std::vector<Projectile> m_projectiles;
-
 public:
     Player();
 
+    uint32_t generation = 0;    // Set by the game on placement, checked by PlayerHandle
     bool isMainPlayer = false;
     bool isAI = false;
     int team = 0;
@@ -32,6 +31,7 @@ public:
     float lastKillTime = -1.0f;
 
     glm::vec3 position;
+    glm::vec3 previousPosition; // Position at the start of the frame, for swept hits
     glm::vec3 velocity;
     glm::quat rotation;
 
@@ -50,6 +50,7 @@ public:
     float m_timeSinceLastShot = 0.0f;
     float fireRate = 0.2f; 
     float SPAWN_OFFSET = 0.5f; // Distance from ship center
+    Beam m_beam;                // Lit while a LASER ship holds fire
 
     // Movement properties
     float maxSpeed = 75.0f;         // Maximum speed limit
@@ -70,6 +71,7 @@ public:
     float FRICTION_FACTOR = 0.7f;
     float COLLISION_DAMAGE_MULTIPLIER = 0.8f;
     float COLLISION_BASE_DAMAGE = 15.0f;
+    static constexpr float COLLISION_SKIN = 0.01f;  // Gap left between hull and terrain after a bounce
     float MAP_BOUNDARY = 150.0f;
     float m_lastCollisionTime = -1.0f;
     static constexpr float COLLISION_DAMAGE_COOLDOWN = 0.5f;
@@ -109,7 +111,7 @@ public:
     bool TakeDamage(float damage, Game& game);
     bool IsAlive() const { return isAlive; }
 
-    void ProcessKeyboardInput(GLFWwindow* window, float deltaTime);
+    void ProcessKeyboardInput(GLFWwindow* window, float deltaTime, Game& game);
     void ProcessMouseInput(GLFWwindow* window, float deltaTime, Game& game);
 
     // Getters
@@ -117,14 +119,6 @@ public:
     glm::vec3 GetRight() const   { return rotation * glm::vec3(1.0f, 0.0f, 0.0f); }
     glm::vec3 GetUp() const      { return rotation * glm::vec3(0.0f, 1.0f, 0.0f); }
 
-    void TransferProjectiles(std::vector<Projectile>& gameProjectiles) {
-        gameProjectiles.insert(gameProjectiles.end(), 
-            std::make_move_iterator(m_projectiles.begin()), 
-            std::make_move_iterator(m_projectiles.end())
-        );
-        m_projectiles.clear();
-    }
-
     float GetRoll() const;
     void SetReticleOffset(const glm::vec2& offset) {m_reticleOffset = offset; }
 };
\ No newline at end of file
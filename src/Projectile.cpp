@@ -1,82 +1,384 @@
 #include "Projectile.hpp"
 #include "Game.hpp"
+#include <algorithm>
+#include <cfloat>
 #include <iostream>
 
-Projectile::Projectile(glm::vec3 pos, glm::vec3 dir, ProjectileType t, float damage)
-    : position(pos), direction(glm::normalize(dir)), type(t), damage(damage), m_shouldDestroy(false) {
-    const auto& stats = PROJECTILE_STATS.at(type); // Retrieve stats for the given type
-
-    speed = stats.speed;
-    lifetime = stats.lifetime;
-    collisionRadius = stats.collisionRadius;
-
-    // Specific properties
-    if (type == ProjectileType::LASER) {
-        tickInterval = stats.tickInterval;
-    } else if (type == ProjectileType::EXPLOSIVE) {
-        explosionRadius = stats.explosionRadius;
-    }
-}
-
-void Projectile::Update(float deltaTime, std::vector<Player>& players, Game& game) {
-    if (m_shouldDestroy) return;
-    
-    if (type == ProjectileType::BULLET || type == ProjectileType::LASER || type == ProjectileType::EXPLOSIVE) {
-        position += direction * speed * deltaTime;
-        lifetime -= deltaTime;
-        PlayerCollisionDetection(players, game);
-        TerrainCollisionDetection(game);
-    }
-
-    if (lifetime <= 0.0f) MarkForDestruction();
-
-    if (m_shouldDestroy) {
-        if (type == ProjectileType::EXPLOSIVE) {
-            collisionRadius = explosionRadius;
-            PlayerCollisionDetection(players, game);
-            game.GetParticles().CreateEmitter(
-                ParticleType::EXPLOSION_SMALL,
-                position,
-                0.1f,
-                500,
-                glm::vec3(1.0f, 0.9f, 0.0f), // Start color (bright yellow)
-                glm::vec3(1.0f, 0.5f, 0.0f) // End color (orange)
-            );
+// Restrict-qualified parameters tell the compiler the arrays never overlap,
+// so the loop vectorizes without runtime alias checks
+static void IntegrateArrays(float* __restrict positionX, float* __restrict positionY, float* __restrict positionZ,
+    const float* __restrict velocityX, const float* __restrict velocityY, const float* __restrict velocityZ,
+    float* __restrict lifetime, size_t count, float deltaTime) {
+    for (size_t i = 0; i < count; i++) {
+        positionX[i] += velocityX[i] * deltaTime;
+        positionY[i] += velocityY[i] * deltaTime;
+        positionZ[i] += velocityZ[i] * deltaTime;
+        lifetime[i] -= deltaTime;
+    }
+}
+
+void ProjectileBatch::Reserve(size_t capacity) {
+    positionX.reserve(capacity);
+    positionY.reserve(capacity);
+    positionZ.reserve(capacity);
+    velocityX.reserve(capacity);
+    velocityY.reserve(capacity);
+    velocityZ.reserve(capacity);
+    lifetime.reserve(capacity);
+    damage.reserve(capacity);
+    source.reserve(capacity);
+    sourceTeam.reserve(capacity);
+    slot.reserve(capacity);
+    destroyed.reserve(capacity);
+}
+
+void ProjectileBatch::Clear() {
+    positionX.clear();
+    positionY.clear();
+    positionZ.clear();
+    velocityX.clear();
+    velocityY.clear();
+    velocityZ.clear();
+    lifetime.clear();
+    damage.clear();
+    source.clear();
+    sourceTeam.clear();
+    slot.clear();
+    destroyed.clear();
+}
+
+void ProjectileBatch::SwapRemove(size_t i) {
+    const size_t last = Size() - 1;
+    if (i != last) {
+        positionX[i] = positionX[last];
+        positionY[i] = positionY[last];
+        positionZ[i] = positionZ[last];
+        velocityX[i] = velocityX[last];
+        velocityY[i] = velocityY[last];
+        velocityZ[i] = velocityZ[last];
+        lifetime[i] = lifetime[last];
+        damage[i] = damage[last];
+        source[i] = source[last];
+        sourceTeam[i] = sourceTeam[last];
+        slot[i] = slot[last];
+        destroyed[i] = destroyed[last];
+    }
+    positionX.pop_back();
+    positionY.pop_back();
+    positionZ.pop_back();
+    velocityX.pop_back();
+    velocityY.pop_back();
+    velocityZ.pop_back();
+    lifetime.pop_back();
+    damage.pop_back();
+    source.pop_back();
+    sourceTeam.pop_back();
+    slot.pop_back();
+    destroyed.pop_back();
+}
+
+void ProjectileStore::SetCapacity(size_t capacity) {
+    Clear();
+    m_capacity = capacity;
+    for (ProjectileBatch& batch : m_batches) {
+        batch.Reserve(capacity);
+    }
+    m_slots.reserve(capacity * PROJECTILE_TYPE_COUNT);
+    m_freeSlots.reserve(capacity * PROJECTILE_TYPE_COUNT);
+}
+
+ProjectileHandle ProjectileStore::Spawn(const glm::vec3& position, const glm::vec3& direction, ProjectileType type,
+    float damage, PlayerHandle source, int sourceTeam) {
+    if (type == ProjectileType::NONE) return ProjectileHandle{};
+    ProjectileBatch& batch = m_batches[static_cast<int>(type)];
+    if (batch.Size() >= m_capacity) {
+        m_droppedSpawns++;
+        return ProjectileHandle{};
+    }
+
+    const uint32_t slotIndex = AllocateSlot(type, static_cast<uint32_t>(batch.Size()));
+    const ProjectileParams& stats = GetProjectileStats(type);
+    const glm::vec3 velocity = glm::normalize(direction) * stats.speed;
+    batch.positionX.push_back(position.x);
+    batch.positionY.push_back(position.y);
+    batch.positionZ.push_back(position.z);
+    batch.velocityX.push_back(velocity.x);
+    batch.velocityY.push_back(velocity.y);
+    batch.velocityZ.push_back(velocity.z);
+    batch.lifetime.push_back(stats.lifetime);
+    batch.damage.push_back(damage);
+    batch.source.push_back(source);
+    batch.sourceTeam.push_back(sourceTeam);
+    batch.slot.push_back(slotIndex);
+    batch.destroyed.push_back(0);
+    return ProjectileHandle{slotIndex, m_slots[slotIndex].generation};
+}
+
+size_t ProjectileStore::SpawnVolley(const glm::vec3* positions, const glm::vec3* directions, size_t count,
+    ProjectileType type, float damage, PlayerHandle source, int sourceTeam) {
+    if (type == ProjectileType::NONE) return 0;
+    ProjectileBatch& batch = m_batches[static_cast<int>(type)];
+    const size_t room = m_capacity > batch.Size() ? m_capacity - batch.Size() : 0;
+    if (count > room) {
+        m_droppedSpawns += count - room;
+        count = room;
+    }
+
+    const size_t first = batch.Size();
+    const ProjectileParams& stats = GetProjectileStats(type);
+    for (size_t i = 0; i < count; i++) {
+        const glm::vec3 velocity = glm::normalize(directions[i]) * stats.speed;
+        batch.positionX.push_back(positions[i].x);
+        batch.positionY.push_back(positions[i].y);
+        batch.positionZ.push_back(positions[i].z);
+        batch.velocityX.push_back(velocity.x);
+        batch.velocityY.push_back(velocity.y);
+        batch.velocityZ.push_back(velocity.z);
+    }
+    // Everything else is shared by the whole volley
+    batch.lifetime.insert(batch.lifetime.end(), count, stats.lifetime);
+    batch.damage.insert(batch.damage.end(), count, damage);
+    batch.source.insert(batch.source.end(), count, source);
+    batch.sourceTeam.insert(batch.sourceTeam.end(), count, sourceTeam);
+    batch.destroyed.insert(batch.destroyed.end(), count, 0);
+    for (size_t i = 0; i < count; i++) {
+        batch.slot.push_back(AllocateSlot(type, static_cast<uint32_t>(first + i)));
+    }
+    return count;
+}
+
+uint32_t ProjectileStore::AllocateSlot(ProjectileType type, uint32_t index) {
+    // Reuse a freed slot first, its generation was bumped when it was freed
+    uint32_t slotIndex;
+    if (!m_freeSlots.empty()) {
+        slotIndex = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        slotIndex = static_cast<uint32_t>(m_slots.size());
+        m_slots.emplace_back();
+    }
+    m_slots[slotIndex].type = type;
+    m_slots[slotIndex].index = index;
+    return slotIndex;
+}
+
+bool ProjectileStore::Find(ProjectileHandle handle, ProjectileType& type, size_t& index) const {
+    if (!handle.IsValid() || handle.index >= m_slots.size()) return false;
+    const ProjectileSlot& slot = m_slots[handle.index];
+    if (slot.generation != handle.generation || slot.type == ProjectileType::NONE) return false;
+    type = slot.type;
+    index = slot.index;
+    return true;
+}
+
+void ProjectileStore::Remove(ProjectileBatch& batch, size_t i) {
+    // Free the slot, then point the slot of the entry moving into i at its new index
+    ProjectileSlot& freed = m_slots[batch.slot[i]];
+    freed.generation++;
+    freed.type = ProjectileType::NONE;
+    m_freeSlots.push_back(batch.slot[i]);
+
+    batch.SwapRemove(i);
+    if (i < batch.Size()) m_slots[batch.slot[i]].index = static_cast<uint32_t>(i);
+}
+
+void ProjectileStore::Update(float deltaTime, std::vector<Player>& players, Game& game) {
+    m_explosions.clear();
+    UpdateBatches(std::make_integer_sequence<int, PROJECTILE_TYPE_COUNT>(), deltaTime, players, game);
+    ResolveExplosions(players, game);
+}
+
+void ProjectileStore::RemoveDestroyed() {
+    for (ProjectileBatch& batch : m_batches) {
+        // Swapped-in entries land on i, so only advance past survivors
+        for (size_t i = 0; i < batch.Size();) {
+            if (batch.destroyed[i]) {
+                Remove(batch, i);
+            } else {
+                i++;
+            }
         }
     }
 }
 
-void Projectile::PlayerCollisionDetection(std::vector<Player>& players, Game& game) {
-    for (auto& player : players) {
-        if (&player == sourcePlayer || player.team == sourcePlayer->team || !player.isAlive) continue;
+void ProjectileStore::Clear() {
+    for (ProjectileBatch& batch : m_batches) {
+        batch.Clear();
+    }
+    // Every outstanding handle goes stale, slots are handed out again from the free list
+    m_freeSlots.clear();
+    for (uint32_t i = 0; i < m_slots.size(); i++) {
+        m_slots[i].generation++;
+        m_slots[i].type = ProjectileType::NONE;
+        m_freeSlots.push_back(i);
+    }
+}
+
+size_t ProjectileStore::Size() const {
+    size_t count = 0;
+    for (const ProjectileBatch& batch : m_batches) {
+        count += batch.Size();
+    }
+    return count;
+}
 
-        glm::vec3 delta = player.position - position;
-        float distanceSq = glm::dot(delta, delta);
-        float radiusSum = player.collisionRadius + collisionRadius;
+// Per-type behaviour of the shared update loop. Every type that can be in flight
+// needs a specialization, a missing one fails to compile rather than falling
+// back to a default at runtime.
+template <ProjectileType Type>
+struct ProjectileKernel;
 
-        if (distanceSq < (radiusSum * radiusSum)) {
-            bool killed = player.TakeDamage(damage, game);
+template <>
+struct ProjectileKernel<ProjectileType::BULLET> {
+    static void OnDestroyed(const ProjectileBatch&, size_t, std::vector<Explosion>&, Game&) {}
+};
 
-            // Only trigger hitmarker if the MAIN PLAYER is the source
-            if (sourcePlayer && sourcePlayer->isMainPlayer) {
-                if (killed) {
-                    sourcePlayer->lastKillTime = game.m_totalTime;
-                    game.ReportPlayerKilled();
-                } else {
-                    sourcePlayer->lastHitTime = game.m_totalTime;
-                    game.ReportPlayerHit();
-                }
-            }                
+template <>
+struct ProjectileKernel<ProjectileType::LASER> {
+    static void OnDestroyed(const ProjectileBatch&, size_t, std::vector<Explosion>&, Game&) {}
+};
+
+template <>
+struct ProjectileKernel<ProjectileType::EXPLOSIVE> {
+    static void OnDestroyed(const ProjectileBatch& batch, size_t i, std::vector<Explosion>& explosions, Game& game) {
+        explosions.push_back({batch.GetPosition(i), GetProjectileStats(ProjectileType::EXPLOSIVE).explosionRadius,
+            batch.damage[i], batch.source[i], batch.sourceTeam[i]});
+        game.GetParticles().CreateEmitter(
+            ParticleType::EXPLOSION_SMALL,
+            batch.GetPosition(i),
+            0.1f,
+            500,
+            glm::vec3(1.0f, 0.9f, 0.0f), // Start color (bright yellow)
+            glm::vec3(1.0f, 0.5f, 0.0f) // End color (orange)
+        );
+    }
+};
+
+template <int... Types>
+void ProjectileStore::UpdateBatches(std::integer_sequence<int, Types...>, float deltaTime,
+    std::vector<Player>& players, Game& game) {
+    (UpdateBatch<static_cast<ProjectileType>(Types)>(deltaTime, players, game), ...);
+}
+
+template <ProjectileType Type>
+void ProjectileStore::UpdateBatch(float deltaTime, std::vector<Player>& players, Game& game) {
+    ProjectileBatch& batch = m_batches[static_cast<int>(Type)];
+    const size_t count = batch.Size();
+    if (count == 0) return;
+
+    const float radius = GetProjectileStats(Type).collisionRadius;
+    QueryTerrain(batch, radius, deltaTime, game);
+    Integrate(batch, deltaTime);
+
+    for (size_t i = 0; i < count; i++) {
+        if (batch.destroyed[i]) continue;
+        const glm::vec3 position = batch.GetPosition(i);
+        const glm::vec3 previousPosition = position - batch.GetVelocity(i) * deltaTime;
+
+        // Whichever of terrain and ships the frame's motion reaches first takes the hit
+        float hitTime = 1.0f;
+        bool hit = TerrainCollisionDetection(previousPosition, position, radius, game, m_terrainHeights[i], hitTime);
+        hit |= PlayerCollisionDetection(batch, i, previousPosition, position, radius, hitTime, players, game);
+        if (hit) {
+            batch.SetPosition(i, glm::mix(previousPosition, position, hitTime));
+            batch.destroyed[i] = 1;
+        }
+        if (batch.lifetime[i] <= 0.0f) batch.destroyed[i] = 1;
+
+        if (batch.destroyed[i]) ProjectileKernel<Type>::OnDestroyed(batch, i, m_explosions, game);
+    }
+}
 
-            MarkForDestruction();
-            break;
+void ProjectileStore::QueryTerrain(const ProjectileBatch& batch, float radius, float deltaTime, const Game& game) {
+    // Query the terrain under every end-of-frame position in one batch,
+    // leaving out the ones the height pyramid already puts above the terrain
+    const size_t count = batch.Size();
+    m_queryPoints.clear();
+    m_queryIndices.clear();
+    m_terrainHeights.assign(count, Heightfield::NO_TERRAIN);
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 position = batch.GetPosition(i);
+        glm::vec3 nextPosition = position + batch.GetVelocity(i) * deltaTime;
+        // Ground that hasn't streamed in yet stops rounds instead of letting them through
+        if (game.IsTerrainStreaming(nextPosition.x, nextPosition.z)) {
+            m_terrainHeights[i] = FLT_MAX;
+            continue;
         }
+        if (game.IsAboveTerrain(position, nextPosition, radius)) continue;
+
+        m_queryPoints.push_back(glm::vec2(nextPosition.x, nextPosition.z));
+        m_queryIndices.push_back(static_cast<uint32_t>(i));
+    }
+    m_queryHeights.resize(m_queryPoints.size());
+    game.QueryTerrainHeights(m_queryPoints.data(), m_queryHeights.data(), m_queryPoints.size());
+    for (size_t i = 0; i < m_queryIndices.size(); i++) {
+        m_terrainHeights[m_queryIndices[i]] = m_queryHeights[i];
     }
 }
 
-void Projectile::TerrainCollisionDetection(const Game& game) {
-    const float terrainHeight = game.GetTerrainHeight(position.x, position.z);
-    if(position.y - collisionRadius <= terrainHeight) {
-        MarkForDestruction();
+void ProjectileStore::Integrate(ProjectileBatch& batch, float deltaTime) {
+    IntegrateArrays(batch.positionX.data(), batch.positionY.data(), batch.positionZ.data(),
+        batch.velocityX.data(), batch.velocityY.data(), batch.velocityZ.data(),
+        batch.lifetime.data(), batch.Size(), deltaTime);
+}
+
+bool ProjectileStore::PlayerCollisionDetection(const ProjectileBatch& batch, size_t i, const glm::vec3& previousPosition,
+    const glm::vec3& position, float radius, float& hitTime, std::vector<Player>& players, Game& game) {
+    // Sweep the frame's motion against each ship's, so hits don't depend on the frame rate.
+    // The earliest contact wins, ties go to the lowest player index.
+    const int sourceTeam = batch.sourceTeam[i];
+    uint32_t hitIndex = UINT32_MAX;
+    game.GetShipGrid().ForEachSweptHit(previousPosition, position, radius, [&](const ShipGrid::Entry& ship, float time) {
+        if (ship.team == sourceTeam || !players[ship.player].isAlive) return;
+        if (time < hitTime || (time == hitTime && ship.player < hitIndex)) {
+            hitTime = time;
+            hitIndex = ship.player;
+        }
+    });
+    if (hitIndex == UINT32_MAX) return false;
+
+    game.DamagePlayer(players[hitIndex], batch.damage[i], batch.source[i]);
+    return true;
+}
+
+void ProjectileStore::ResolveExplosions(std::vector<Player>& players, Game& game) {
+    // Every enemy ship in reach takes damage scaled by how far its hull is from the
+    // center. Occlusion rays are capped per frame so a salvo of bombs can't stall it,
+    // past the cap only blasts the height pyramid proves clear of the terrain get through.
+    int occlusionRays = game.m_explosionOcclusion ? MAX_OCCLUSION_RAYS : 0;
+    for (const Explosion& explosion : m_explosions) {
+        game.GetShipGrid().ForEachOverlap(explosion.position, explosion.radius, [&](const ShipGrid::Entry& ship) {
+            if (ship.team == explosion.sourceTeam || !players[ship.player].isAlive) return;
+
+            const float distance = std::max(glm::length(ship.position - explosion.position) - ship.radius, 0.0f);
+            const float falloff = 1.0f - distance / explosion.radius;
+            if (falloff <= 0.0f) return;
+
+            if (game.m_explosionOcclusion) {
+                if (occlusionRays > 0) {
+                    occlusionRays--;
+                    if (!game.HasLineOfSight(explosion.position, ship.position)) return;
+                } else if (!game.IsAboveTerrain(explosion.position, ship.position, 0.0f)) {
+                    return;
+                }
+            }
+            game.DamagePlayer(players[ship.player], explosion.damage * falloff, explosion.source);
+        });
+    }
+}
+
+bool ProjectileStore::TerrainCollisionDetection(const glm::vec3& previousPosition, const glm::vec3& position,
+    float radius, const Game& game, float terrainHeight, float& hitTime) {
+    // Sweep the whole frame's motion so fast rounds can't tunnel through ridges
+    TerrainHit hit;
+    if (game.SweepSphereTerrain(previousPosition, position, radius, hit)) {
+        hitTime = hit.time;
+        return true;
+    }
+
+    if (position.y - radius <= terrainHeight) {
+        hitTime = 1.0f;
+        return true;
     }
+    return false;
 }
\ No newline at end of file
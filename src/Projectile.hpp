@@ -1,14 +1,28 @@
 #pragma once
-#include <string>
-#include <unordered_map>
+#include <array>
 #include <vector>
+#include <cstdint>
+#include <utility>
 #include <glm/glm.hpp>
+#include "Handle.hpp"
+#include "StatTable.hpp"
 
 class Game;
 class Player;
 
+enum class ProjectileType : int {
+    BULLET,
+    LASER,
+    EXPLOSIVE,
+    NONE
+};
+
+// Number of types that can be in flight, NONE is never spawned
+static constexpr int PROJECTILE_TYPE_COUNT = static_cast<int>(ProjectileType::NONE);
+
 struct ProjectileParams {
-    std::string name;
+    ProjectileType type;
+    const char* name;
 
     float speed;
     float baseDamage;
@@ -18,85 +32,163 @@ struct ProjectileParams {
     // Laser-specific properties
     float damagePerTick;
     float tickInterval;
-    float timeSinceLastTick;
 
     // Explosive-specific properties
     float explosionRadius;
 };
 
-enum class ProjectileType : int {
-    BULLET,
-    LASER,
-    EXPLOSIVE,
-    NONE
-};
-
-inline const std::unordered_map<ProjectileType, ProjectileParams> PROJECTILE_STATS = {
-    {ProjectileType::BULLET, {
+inline constexpr std::array<ProjectileParams, PROJECTILE_TYPE_COUNT + 1> PROJECTILE_STATS = {{
+    {
+        .type = ProjectileType::BULLET,
         .name = "Bullets",
         .speed = 75.0f,
         .baseDamage = 7.5f,
         .lifetime = 2.0f,
         .collisionRadius = 0.5f
-    }},
+    },
 
-    {ProjectileType::LASER, {
+    {
+        .type = ProjectileType::LASER,
         .name = "Laser",
         .speed = 750.0f,
         .baseDamage = 2.5f,
         .lifetime = 0.15f,
         .collisionRadius = 0.8f,
+        .damagePerTick = 15.0f,
         .tickInterval = 0.1f
-    }},
+    },
 
-    {ProjectileType::EXPLOSIVE, {
+    {
+        .type = ProjectileType::EXPLOSIVE,
         .name = "Explosive",
         .speed = 60.0f,
         .baseDamage = 50.0f,
         .lifetime = 2.5f,
         .collisionRadius = 0.6f,
         .explosionRadius = 8.0f
-    }},
+    },
 
-    {ProjectileType::NONE, {
+    {
+        .type = ProjectileType::NONE,
         .name = "NONE",
         .speed = 0.0f,
         .baseDamage = 0.0f,
         .lifetime = 0.0f,
         .collisionRadius = 0.0f
-    }}
+    }
+}};
+static_assert(IsIndexedByType(PROJECTILE_STATS), "PROJECTILE_STATS must list every ProjectileType in order");
+
+constexpr const ProjectileParams& GetProjectileStats(ProjectileType type) {
+    return PROJECTILE_STATS[static_cast<size_t>(type)];
+}
+
+// Where a ProjectileHandle's slot currently points
+struct ProjectileSlot {
+    uint32_t generation = 0;
+    ProjectileType type = ProjectileType::NONE;
+    uint32_t index = 0;             // Dense index in the type's batch
 };
 
-struct Projectile {
-public:
-    Projectile(glm::vec3 pos, glm::vec3 dir, ProjectileType t, float damage);
+// Live projectiles of one type, one array per field and densely packed.
+// Speed and collision radius are the same for the whole type, so only
+// per-projectile state is stored, and the movement pass streams nothing
+// but the hot arrays.
+struct ProjectileBatch {
+    // Hot, read and written for every projectile every frame
+    std::vector<float> positionX, positionY, positionZ;
+    std::vector<float> velocityX, velocityY, velocityZ;     // Direction premultiplied by the type's speed
+    std::vector<float> lifetime;
+
+    // Cold, only read when something is hit
+    std::vector<float> damage;
+    std::vector<PlayerHandle> source;
+    std::vector<int> sourceTeam;    // Kept so friendly fire stays off after the owner is gone
+    std::vector<uint32_t> slot;     // Back reference for fixing the handle table on swap-remove
+    std::vector<uint8_t> destroyed;
+
+    size_t Size() const { return lifetime.size(); }
+    glm::vec3 GetPosition(size_t i) const { return glm::vec3(positionX[i], positionY[i], positionZ[i]); }
+    glm::vec3 GetVelocity(size_t i) const { return glm::vec3(velocityX[i], velocityY[i], velocityZ[i]); }
+    void SetPosition(size_t i, const glm::vec3& position) {
+        positionX[i] = position.x;
+        positionY[i] = position.y;
+        positionZ[i] = position.z;
+    }
+
+    void Reserve(size_t capacity);
+    void Clear();
+    // Moves the last entry into i, O(1) but does not keep order
+    void SwapRemove(size_t i);
+};
 
-    std::vector<Player*> hitPlayers;
-    Player* sourcePlayer = nullptr;
-    
+// Blast queued when an EXPLOSIVE dies, resolved once every batch has moved
+struct Explosion {
     glm::vec3 position;
-    glm::vec3 direction;
-    ProjectileType type;
-
-    float speed;
-    float baseDamage;
-    float lifetime;
-    float collisionRadius;
-
-    // Laser-specific properties
-    float damagePerTick;
-    float tickInterval;
-    float timeSinceLastTick;
-
-    // Explosive-specific properties
-    float explosionRadius;
+    float radius;
+    float damage;                   // Dealt in full at the center, falling to nothing at the edge
+    PlayerHandle source;
+    int sourceTeam;
+};
 
-    float damage;
-    bool m_shouldDestroy;
+// Fixed-capacity pool of every live projectile. Spawning never allocates,
+// it fails once a type is at capacity, and removal is a swap with the last
+// entry of the batch. Handles stay valid across swaps until the projectile dies.
+class ProjectileStore {
+public:
+    // Capacity per type, drops everything in flight
+    void SetCapacity(size_t capacity);
+    size_t GetCapacity() const { return m_capacity; }
+
+    // Invalid handle when the type is at capacity
+    ProjectileHandle Spawn(const glm::vec3& position, const glm::vec3& direction, ProjectileType type,
+        float damage, PlayerHandle source, int sourceTeam);
+    // Spawns a volley of one type in a single pass over each array. Shots past
+    // the type's capacity are dropped, returns how many were spawned.
+    size_t SpawnVolley(const glm::vec3* positions, const glm::vec3* directions, size_t count, ProjectileType type,
+        float damage, PlayerHandle source, int sourceTeam);
+    // Batch and dense index of a live projectile, false once it has been removed
+    bool Find(ProjectileHandle handle, ProjectileType& type, size_t& index) const;
 
     void Update(float deltaTime, std::vector<Player>& players, Game& game);
-    void PlayerCollisionDetection(std::vector<Player>& players, Game& game);
-    void TerrainCollisionDetection(const Game& game);
-    bool ShouldDestroy() const { return m_shouldDestroy; }
-    void MarkForDestruction() { m_shouldDestroy = true; }
+    void RemoveDestroyed();
+    void Clear();
+
+    size_t Size() const;
+    uint64_t GetDroppedSpawns() const { return m_droppedSpawns; }
+    const ProjectileBatch& GetBatch(ProjectileType type) const { return m_batches[static_cast<int>(type)]; }
+
+private:
+    ProjectileBatch m_batches[PROJECTILE_TYPE_COUNT];
+    size_t m_capacity = 0;
+    std::vector<ProjectileSlot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+    uint64_t m_droppedSpawns = 0;
+
+    // Per-frame scratch for the batched terrain query
+    std::vector<glm::vec2> m_queryPoints;
+    std::vector<uint32_t> m_queryIndices;
+    std::vector<float> m_queryHeights;
+    std::vector<float> m_terrainHeights;
+
+    // Blasts from this frame, and how many terrain rays they may still cast
+    std::vector<Explosion> m_explosions;
+    static constexpr int MAX_OCCLUSION_RAYS = 256;
+
+    uint32_t AllocateSlot(ProjectileType type, uint32_t index);
+    void Remove(ProjectileBatch& batch, size_t i);
+    // One instantiation per type, the type's ProjectileKernel supplies what differs between them
+    template <int... Types>
+    void UpdateBatches(std::integer_sequence<int, Types...>, float deltaTime, std::vector<Player>& players, Game& game);
+    template <ProjectileType Type>
+    void UpdateBatch(float deltaTime, std::vector<Player>& players, Game& game);
+    // Terrain height under every end-of-frame position, NO_TERRAIN where the pyramid rules out contact
+    void QueryTerrain(const ProjectileBatch& batch, float radius, float deltaTime, const Game& game);
+    static void Integrate(ProjectileBatch& batch, float deltaTime);
+    // Swept tests over previousPosition -> position; on a hit they lower hitTime to the contact time
+    static bool PlayerCollisionDetection(const ProjectileBatch& batch, size_t i, const glm::vec3& previousPosition,
+        const glm::vec3& position, float radius, float& hitTime, std::vector<Player>& players, Game& game);
+    static bool TerrainCollisionDetection(const glm::vec3& previousPosition, const glm::vec3& position,
+        float radius, const Game& game, float terrainHeight, float& hitTime);
+    void ResolveExplosions(std::vector<Player>& players, Game& game);
 };
\ No newline at end of file
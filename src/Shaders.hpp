@@ -67,6 +67,126 @@ const char* fragmentShaderSource = R"(
     }
 )";
 
+// Terrain LOD tiles: the model layout, vertices left at NO_TERRAIN mark holes
+const char* terrainVertexShader = R"(
+    #version 330 core
+    layout (location = 0) in vec3 aPos;
+    layout (location = 1) in vec3 aColor;
+    layout (location = 2) in vec3 aNormal;
+
+    const float NO_TERRAIN = -1000.0;   // Heightfield::NO_TERRAIN
+
+    uniform mat4 model;
+    uniform mat4 view;
+    uniform mat4 projection;
+
+    out vec3 FragPos;
+    out vec3 Normal;
+    out vec3 Color;
+    out float Hole;
+
+    void main() {
+        gl_Position = projection * view * model * vec4(aPos, 1.0);
+        FragPos = vec3(model * vec4(aPos, 1.0));
+        Normal = mat3(transpose(inverse(model))) * aNormal;
+        Color = aColor;
+        // Skirts under a hole sit below it too
+        Hole = aPos.y <= NO_TERRAIN ? 1.0 : 0.0;
+    }
+)";
+
+// Model lighting for both terrain paths, any triangle touching a hole vertex is dropped
+const char* terrainFragmentShader = R"(
+    #version 330 core
+    in vec3 FragPos;
+    in vec3 Normal;
+    in vec3 Color;
+    in float Hole;
+    uniform vec3 objectColor;
+    out vec4 FragColor;
+
+    uniform vec3 lightPos;
+    uniform vec3 lightColor;
+    uniform vec3 viewPos;
+
+    void main() {
+        // Interpolated flag is above zero everywhere inside such a triangle
+        if (Hole > 0.0) discard;
+
+        float ambientStrength = 0.2;
+        vec3 ambient = ambientStrength * lightColor;
+
+        vec3 norm = normalize(Normal);
+        vec3 lightDir = normalize(lightPos - FragPos);
+        float diff = max(dot(norm, lightDir), 0.0);
+        vec3 diffuse = diff * lightColor;
+
+        float specularStrength = 0.5;
+        vec3 viewDir = normalize(viewPos - FragPos);
+        vec3 reflectDir = reflect(-lightDir, norm);
+        float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+        vec3 specular = specularStrength * spec * lightColor;
+
+        vec3 result = (ambient + diffuse + specular) * objectColor;
+        FragColor = vec4(result, 1.0);
+    }
+)";
+
+// Heightfield terrain: positions and normals pulled from the height texture,
+// lit by terrainFragmentShader like the LOD tiles
+const char* heightfieldVertexShader = R"(
+    #version 330 core
+    layout (location = 0) in vec2 aGrid;    // Texel offset inside the patch
+    layout (location = 1) in vec2 aPatch;   // First texel of the patch, per instance
+
+    const float NO_TERRAIN = -1000.0;   // Heightfield::NO_TERRAIN, texels the bake did not cover
+
+    uniform sampler2D heightMap;
+    uniform vec2 terrainOrigin;
+    uniform float terrainSpacing;
+    uniform mat4 model;
+    uniform mat4 view;
+    uniform mat4 projection;
+
+    out vec3 FragPos;
+    out vec3 Normal;
+    out vec3 Color;
+    out float Hole;
+
+    float HeightAt(ivec2 texel) {
+        texel = clamp(texel, ivec2(0), textureSize(heightMap, 0) - 1);
+        return texelFetch(heightMap, texel, 0).r;
+    }
+
+    // Hole neighbours fall back to the centre so edge normals stay level
+    float NeighbourAt(ivec2 texel, float centre) {
+        float h = HeightAt(texel);
+        return h <= NO_TERRAIN ? centre : h;
+    }
+
+    void main() {
+        // Patches past the far edge fold onto the last texel
+        ivec2 texel = min(ivec2(aPatch + aGrid), textureSize(heightMap, 0) - 1);
+        float height = HeightAt(texel);
+        vec3 position = vec3(terrainOrigin.x + float(texel.x) * terrainSpacing,
+                             height,
+                             terrainOrigin.y + float(texel.y) * terrainSpacing);
+
+        // Central differences over the neighbouring texels
+        float left = NeighbourAt(texel - ivec2(1, 0), height);
+        float right = NeighbourAt(texel + ivec2(1, 0), height);
+        float back = NeighbourAt(texel - ivec2(0, 1), height);
+        float front = NeighbourAt(texel + ivec2(0, 1), height);
+        vec3 normal = normalize(vec3(left - right, 2.0 * terrainSpacing, back - front));
+
+        gl_Position = projection * view * model * vec4(position, 1.0);
+        FragPos = vec3(model * vec4(position, 1.0));
+        Normal = mat3(transpose(inverse(model))) * normal;
+        Color = vec3(0.7);
+        Hole = height <= NO_TERRAIN ? 1.0 : 0.0;
+    }
+)";
+
 const char* laserVertexShader = R"( 
     #version 330 core
     layout (location = 0) in vec3 aPos;
@@ -1,8 +1,8 @@
 #pragma once
-#include "Model.hpp"
-#include <unordered_map>
-
-enum class ProjectileType : int;
+#include "Projectile.hpp"
+#include "StatTable.hpp"
+#include <array>
+#include <vector>
 
 enum class ShipType {
     XR9,
@@ -11,6 +11,8 @@ enum class ShipType {
     SPEAR
 };
 
+static constexpr int SHIP_TYPE_COUNT = static_cast<int>(ShipType::SPEAR) + 1;
+
 inline const std::vector<ShipType> SHIP_ORDER = {
     ShipType::XR9,
     ShipType::HellFire,
@@ -18,14 +20,27 @@ inline const std::vector<ShipType> SHIP_ORDER = {
     ShipType::SPEAR
 };
 
+// Barrel position in ship space
+struct Muzzle {
+    float right;
+    float up;
+    float forward;
+};
+
+static constexpr int MAX_MUZZLES = 4;
+
+// Models are loaded at runtime and live in the game's registry, see Game::GetShipModel
 struct ShipStats {
-    std::string name;
-    Model* model;
+    ShipType type;
+    const char* name;
 
     float maxHealth;
     float fireRate;
     ProjectileType projectileType;
     float projectileDamage;
+    float spread;                   // Random deviation of each shot along right and up, 0 fires straight ahead
+    int muzzleCount;                // Barrels fired together, 0 for unarmed ships
+    std::array<Muzzle, MAX_MUZZLES> muzzles;
 
     float maxSpeed;
     float acceleration;
@@ -36,4 +51,100 @@ struct ShipStats {
     float collisionRadius;
 };
 
-extern std::unordered_map<ShipType, ShipStats> SHIP_STATS;
\ No newline at end of file
+inline constexpr std::array<ShipStats, SHIP_TYPE_COUNT> SHIP_STATS = {{
+    {
+        .type = ShipType::XR9,
+        .name = "XR9",
+
+        .maxHealth = 300.0f,
+        .fireRate = 0.1f,
+        .projectileType = ProjectileType::BULLET,
+        .projectileDamage = GetProjectileStats(ProjectileType::BULLET).baseDamage,
+        .spread = 0.0f,
+        .muzzleCount = 2,
+        .muzzles = {{{0.5f, 0.0f, 1.0f}, {-0.5f, 0.0f, 1.0f}}},
+
+        .maxSpeed = 75.0f,
+        .acceleration = 25.0f,
+        .pitchSpeed = 45.0f,
+        .yawSpeed = 50.0f,
+        .rollSpeed = 110.0f,
+
+        .collisionRadius = 0.6
+    },
+
+    {
+        .type = ShipType::HellFire,
+        .name = "HellFire",
+
+        .maxHealth = 200.0f,
+        .fireRate = 0.0025f,
+        .projectileType = ProjectileType::LASER,
+        .projectileDamage = GetProjectileStats(ProjectileType::LASER).baseDamage,
+        .spread = 0.0f,
+        .muzzleCount = 1,
+        .muzzles = {{{0.3f, -0.1f, -5.0f}}},
+
+        .maxSpeed = 90.0f,
+        .acceleration = 30.0f,
+        .pitchSpeed = 45.0f,
+        .yawSpeed = 50.0f,
+        .rollSpeed = 125.0f,
+
+        .collisionRadius = 0.45
+    },
+
+    {
+        .type = ShipType::HYDRA,
+        .name = "HYDRA",
+
+        .maxHealth = 500.0f,
+        .fireRate = 1.25f,
+        .projectileType = ProjectileType::EXPLOSIVE,
+        .projectileDamage = GetProjectileStats(ProjectileType::EXPLOSIVE).baseDamage,
+        .spread = 0.0f,
+        .muzzleCount = 2,
+        .muzzles = {{{0.45f, -0.2f, 0.0f}, {-0.45f, -0.2f, 0.0f}}},
+
+        .maxSpeed = 55.0f,
+        .acceleration = 20.0f,
+        .pitchSpeed = 45.0f,
+        .yawSpeed = 50.0f,
+        .rollSpeed = 95.0f,
+
+        .collisionRadius = 0.9
+    },
+
+    {
+        .type = ShipType::SPEAR,
+        .name = "SPEAR",
+
+        .maxHealth = 3000.0f,
+        .fireRate = 0.0f,
+        .projectileType = ProjectileType::NONE,
+        .projectileDamage = GetProjectileStats(ProjectileType::EXPLOSIVE).baseDamage,
+        .spread = 0.0f,
+        .muzzleCount = 0,
+
+        .maxSpeed = 150.0f,
+        .acceleration = 50.0f,
+        .pitchSpeed = 45.0f,
+        .yawSpeed = 50.0f,
+        .rollSpeed = 150.0f,
+
+        .collisionRadius = 1.2
+    }
+}};
+static_assert(IsIndexedByType(SHIP_STATS), "SHIP_STATS must list every ShipType in order");
+
+constexpr bool MuzzlesFit(const std::array<ShipStats, SHIP_TYPE_COUNT>& table) {
+    for (const ShipStats& stats : table) {
+        if (stats.muzzleCount < 0 || stats.muzzleCount > MAX_MUZZLES) return false;
+    }
+    return true;
+}
+static_assert(MuzzlesFit(SHIP_STATS), "muzzleCount must fit in MAX_MUZZLES");
+
+constexpr const ShipStats& GetShipStats(ShipType type) {
+    return SHIP_STATS[static_cast<size_t>(type)];
+}
\ No newline at end of file
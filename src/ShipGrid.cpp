@@ -0,0 +1,42 @@
+#include "ShipGrid.hpp"
+#include "Player.hpp"
+#include <algorithm>
+
+void ShipGrid::Build(const std::vector<Player>& players, float cellSize) {
+    m_invCellSize = 1.0f / cellSize;
+    m_maxRadius = 0.0f;
+    m_maxTravel = 0.0f;
+    m_scratch.clear();
+    for (uint32_t i = 0; i < players.size(); i++) {
+        const Player& player = players[i];
+        if (!player.isAlive) continue;
+        m_scratch.push_back({player.position, player.previousPosition, player.collisionRadius,
+            GetCell(player.position), player.team, i});
+        m_maxRadius = std::max(m_maxRadius, player.collisionRadius);
+        m_maxTravel = std::max(m_maxTravel, glm::length(player.position - player.previousPosition));
+    }
+
+    // At least two buckets per ship keeps the chains short
+    uint32_t bucketCount = 1;
+    while (bucketCount < m_scratch.size() * 2) bucketCount <<= 1;
+    m_bucketMask = bucketCount - 1;
+    m_bucketStart.assign(bucketCount + 1, 0);
+    m_entries.resize(m_scratch.size());
+
+    // Count, prefix sum, scatter
+    for (const Entry& entry : m_scratch) {
+        m_bucketStart[GetBucket(entry.cell) + 1]++;
+    }
+    for (uint32_t bucket = 0; bucket < bucketCount; bucket++) {
+        m_bucketStart[bucket + 1] += m_bucketStart[bucket];
+    }
+    for (const Entry& entry : m_scratch) {
+        // Each bucket's start doubles as its write cursor and ends up at the bucket's end
+        m_entries[m_bucketStart[GetBucket(entry.cell)]++] = entry;
+    }
+    // Every end is the next bucket's start, shift them back into place
+    for (uint32_t bucket = bucketCount; bucket > 0; bucket--) {
+        m_bucketStart[bucket] = m_bucketStart[bucket - 1];
+    }
+    m_bucketStart[0] = 0;
+}
\ No newline at end of file
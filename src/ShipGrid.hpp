@@ -0,0 +1,136 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class Player;
+
+// Spatial hash of the live ships, rebuilt every frame. Each ship goes into
+// the one cell holding its center; cells hash into a power-of-two bucket
+// table stored in compressed-sparse-row form, so a rebuild is a count,
+// a prefix sum and a scatter with no allocation once the arrays have grown.
+class ShipGrid {
+public:
+    struct Entry {
+        glm::vec3 position;
+        glm::vec3 previousPosition;     // Where the ship started the frame
+        float radius;
+        glm::ivec3 cell;
+        int team;
+        uint32_t player;        // Index into the players vector
+    };
+
+    void Build(const std::vector<Player>& players, float cellSize);
+
+    // Visits every ship whose collision sphere overlaps the given sphere, each at most once
+    template <typename Visitor>
+    void ForEachOverlap(const glm::vec3& center, float radius, Visitor&& visit) const {
+        const float reach = radius + m_maxRadius;
+        ForEachInBox(center - reach, center + reach, [&](const Entry& entry) {
+            const glm::vec3 delta = entry.position - center;
+            const float radiusSum = entry.radius + radius;
+            if (glm::dot(delta, delta) < radiusSum * radiusSum) visit(entry);
+        });
+    }
+
+    // Visits every ship a sphere moving from -> to touches during the frame, with
+    // the time of first contact as a fraction of the move. Both spheres move, so
+    // the test runs in the ship's frame where only the relative motion remains.
+    template <typename Visitor>
+    void ForEachSweptHit(const glm::vec3& from, const glm::vec3& to, float radius, Visitor&& visit) const {
+        // Ships sit in the cell of their end-of-frame position, widen by how far any of them moved
+        const float reach = radius + m_maxRadius + m_maxTravel;
+        ForEachInBox(glm::min(from, to) - reach, glm::max(from, to) + reach, [&](const Entry& entry) {
+            float time;
+            if (SweepSpheres(from - entry.previousPosition, (to - from) - (entry.position - entry.previousPosition),
+                    radius + entry.radius, time)) {
+                visit(entry, time);
+            }
+        });
+    }
+
+    // Visits every ship a ray of the given thickness passes through within maxDistance,
+    // with the distance along the ray where it first touches the ship
+    template <typename Visitor>
+    void ForEachRayHit(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float radius,
+        Visitor&& visit) const {
+        const glm::vec3 end = origin + direction * maxDistance;
+        const float reach = radius + m_maxRadius;
+        ForEachInBox(glm::min(origin, end) - reach, glm::max(origin, end) + reach, [&](const Entry& entry) {
+            float time;
+            if (SweepSpheres(origin - entry.position, end - origin, radius + entry.radius, time)) {
+                visit(entry, time * maxDistance);
+            }
+        });
+    }
+
+    // Earliest t in [0, 1] where |offset + motion * t| <= radiusSum
+    static bool SweepSpheres(const glm::vec3& offset, const glm::vec3& motion, float radiusSum, float& time) {
+        const float c = glm::dot(offset, offset) - radiusSum * radiusSum;
+        if (c <= 0.0f) {
+            time = 0.0f;
+            return true;
+        }
+        const float a = glm::dot(motion, motion);
+        const float b = glm::dot(offset, motion);
+        if (b >= 0.0f || a <= 0.0f) return false;    // Not closing in
+        const float discriminant = b * b - a * c;
+        if (discriminant < 0.0f) return false;
+        time = (-b - std::sqrt(discriminant)) / a;
+        return time <= 1.0f;
+    }
+
+    size_t GetShipCount() const { return m_entries.size(); }
+    size_t GetBucketCount() const { return m_bucketStart.empty() ? 0 : m_bucketStart.size() - 1; }
+
+private:
+    float m_invCellSize = 1.0f;
+    float m_maxRadius = 0.0f;
+    float m_maxTravel = 0.0f;           // Longest distance any ship moved this frame
+    uint32_t m_bucketMask = 0;
+    std::vector<uint32_t> m_bucketStart;
+    std::vector<Entry> m_entries;       // Sorted by bucket
+    std::vector<Entry> m_scratch;
+
+    // Visits every entry whose cell lies inside the box, each at most once
+    template <typename Visitor>
+    void ForEachInBox(const glm::vec3& minCorner, const glm::vec3& maxCorner, Visitor&& visit) const {
+        if (m_entries.empty()) return;
+        const glm::ivec3 minCell = GetCell(minCorner);
+        const glm::ivec3 maxCell = GetCell(maxCorner);
+
+        // A query wider than the whole fleet is cheaper as a plain scan
+        const int64_t cellCount = static_cast<int64_t>(maxCell.x - minCell.x + 1) *
+            (maxCell.y - minCell.y + 1) * (maxCell.z - minCell.z + 1);
+        if (cellCount > static_cast<int64_t>(m_entries.size())) {
+            for (const Entry& entry : m_entries) visit(entry);
+            return;
+        }
+
+        for (int z = minCell.z; z <= maxCell.z; z++) {
+            for (int y = minCell.y; y <= maxCell.y; y++) {
+                for (int x = minCell.x; x <= maxCell.x; x++) {
+                    const uint32_t bucket = GetBucket(glm::ivec3(x, y, z));
+                    for (uint32_t i = m_bucketStart[bucket]; i < m_bucketStart[bucket + 1]; i++) {
+                        // Other cells can share the bucket, they get visited from their own cell
+                        const Entry& entry = m_entries[i];
+                        if (entry.cell.x == x && entry.cell.y == y && entry.cell.z == z) visit(entry);
+                    }
+                }
+            }
+        }
+    }
+
+    glm::ivec3 GetCell(const glm::vec3& position) const {
+        return glm::ivec3(static_cast<int>(std::floor(position.x * m_invCellSize)),
+                          static_cast<int>(std::floor(position.y * m_invCellSize)),
+                          static_cast<int>(std::floor(position.z * m_invCellSize)));
+    }
+    uint32_t GetBucket(const glm::ivec3& cell) const {
+        const uint32_t hash = (static_cast<uint32_t>(cell.x) * 73856093u) ^
+                              (static_cast<uint32_t>(cell.y) * 19349663u) ^
+                              (static_cast<uint32_t>(cell.z) * 83492791u);
+        return hash & m_bucketMask;
+    }
+};
\ No newline at end of file
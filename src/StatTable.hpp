@@ -0,0 +1,12 @@
+#pragma once
+#include <cstddef>
+
+// Stat tables are std::arrays indexed by their enum. Each entry repeats its
+// own type so a static_assert can catch an entry that is missing or out of order.
+template <typename Table>
+constexpr bool IsIndexedByType(const Table& table) {
+    for (size_t i = 0; i < table.size(); i++) {
+        if (static_cast<size_t>(table[i].type) != i) return false;
+    }
+    return true;
+}
\ No newline at end of file
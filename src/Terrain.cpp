@@ -0,0 +1,1249 @@
+#define GLM_ENABLE_EXPERIMENTAL
+#include "Terrain.hpp"
+#include <glm/gtx/intersect.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define TERRAIN_SIMD_SSE2
+#include <immintrin.h>
+#endif
+
+// Runs work over [0, count) on the pool when there is one, inline otherwise
+static void ForEachBlock(ThreadPool* pool, int count, int grainSize, const std::function<void(int, int)>& work) {
+    if (pool) {
+        pool->ParallelFor(count, grainSize, work);
+    } else {
+        work(0, count);
+    }
+}
+
+void SpatialGrid::Build(const std::vector<TerrainTriangle>& triangles, float cellSize, ThreadPool* pool) {
+    Clear();
+    if (triangles.empty() || cellSize <= 0.0f) return;
+
+    // Grid bounds from the triangle set
+    glm::vec2 minBounds(FLT_MAX);
+    glm::vec2 maxBounds(-FLT_MAX);
+    for (const TerrainTriangle& tri : triangles) {
+        minBounds = glm::min(minBounds, glm::vec2(std::min({tri.v0.x, tri.v1.x, tri.v2.x}),
+                                                  std::min({tri.v0.z, tri.v1.z, tri.v2.z})));
+        maxBounds = glm::max(maxBounds, glm::vec2(std::max({tri.v0.x, tri.v1.x, tri.v2.x}),
+                                                  std::max({tri.v0.z, tri.v1.z, tri.v2.z})));
+    }
+
+    m_origin = minBounds;
+    m_cellSize = cellSize;
+    m_invCellSize = 1.0f / cellSize;
+    m_cellsX = static_cast<int>(std::floor((maxBounds.x - minBounds.x) * m_invCellSize)) + 1;
+    m_cellsZ = static_cast<int>(std::floor((maxBounds.y - minBounds.y) * m_invCellSize)) + 1;
+
+    // One contiguous triangle range per block, at most one block per thread so the
+    // per-block counters stay small. Blocks keep triangle order within every cell.
+    const size_t cellCount = GetCellCount();
+    const int triangleCount = static_cast<int>(triangles.size());
+    const int maxBlocks = pool ? static_cast<int>(pool->GetThreadCount()) + 1 : 1;
+    const int blockCount = std::clamp((triangleCount + 4095) / 4096, 1, maxBlocks);
+    const int blockSize = (triangleCount + blockCount - 1) / blockCount;
+    std::vector<uint32_t> blockCounts(cellCount * blockCount, 0);
+
+    // Pass 1: count triangles per cell, each block into its own row
+    ForEachBlock(pool, blockCount, 1, [&](int firstBlock, int lastBlock) {
+        for (int block = firstBlock; block < lastBlock; block++) {
+            uint32_t* counts = &blockCounts[block * cellCount];
+            const int end = std::min(triangleCount, (block + 1) * blockSize);
+            for (int i = block * blockSize; i < end; i++) {
+                int startX, endX, startZ, endZ;
+                GetCellRange(triangles[i], startX, endX, startZ, endZ);
+                for (int z = startZ; z <= endZ; z++) {
+                    for (int x = startX; x <= endX; x++) {
+                        counts[static_cast<size_t>(z) * m_cellsX + x]++;
+                    }
+                }
+            }
+        }
+    });
+
+    // Per cell, turn the block counts into offsets within the cell and total them
+    m_cellStart.assign(cellCount + 1, 0);
+    ForEachBlock(pool, static_cast<int>(cellCount), 16384, [&](int firstCell, int lastCell) {
+        for (int cell = firstCell; cell < lastCell; cell++) {
+            uint32_t total = 0;
+            for (int block = 0; block < blockCount; block++) {
+                uint32_t& count = blockCounts[block * cellCount + cell];
+                uint32_t blockTotal = count;
+                count = total;
+                total += blockTotal;
+            }
+            m_cellStart[cell + 1] = total;
+        }
+    });
+
+    // Prefix sum turns counts into start offsets
+    for (size_t i = 1; i < m_cellStart.size(); i++) {
+        m_cellStart[i] += m_cellStart[i - 1];
+    }
+
+    // Pass 2: scatter triangle indices, every block writes only its own slots
+    m_triangleIndices.resize(m_cellStart.back());
+    ForEachBlock(pool, blockCount, 1, [&](int firstBlock, int lastBlock) {
+        for (int block = firstBlock; block < lastBlock; block++) {
+            uint32_t* cursor = &blockCounts[block * cellCount];
+            const int end = std::min(triangleCount, (block + 1) * blockSize);
+            for (int i = block * blockSize; i < end; i++) {
+                int startX, endX, startZ, endZ;
+                GetCellRange(triangles[i], startX, endX, startZ, endZ);
+                for (int z = startZ; z <= endZ; z++) {
+                    for (int x = startX; x <= endX; x++) {
+                        const size_t cell = static_cast<size_t>(z) * m_cellsX + x;
+                        m_triangleIndices[m_cellStart[cell] + cursor[cell]++] = static_cast<uint32_t>(i);
+                    }
+                }
+            }
+        }
+    });
+}
+
+void SpatialGrid::Clear() {
+    m_cellStart.clear();
+    m_triangleIndices.clear();
+    m_cellsX = 0;
+    m_cellsZ = 0;
+}
+
+void SpatialGrid::Serialize(TerrainBlobWriter& out) const {
+    out.Write(m_origin);
+    out.Write(m_cellSize);
+    out.Write(m_cellsX);
+    out.Write(m_cellsZ);
+    out.WriteArray(m_cellStart);
+    out.WriteArray(m_triangleIndices);
+}
+
+bool SpatialGrid::Deserialize(TerrainBlobReader& in) {
+    Clear();
+    if (!in.Read(m_origin) || !in.Read(m_cellSize) || !in.Read(m_cellsX) || !in.Read(m_cellsZ) ||
+        !in.ReadArray(m_cellStart) || !in.ReadArray(m_triangleIndices)) {
+        Clear();
+        return false;
+    }
+    m_invCellSize = 1.0f / m_cellSize;
+
+    // Queries index straight into these arrays, so check the shape before trusting it
+    bool valid = m_cellSize > 0.0f && m_cellsX >= 0 && m_cellsZ >= 0 &&
+        (m_cellStart.empty() || (m_cellStart.size() == static_cast<size_t>(m_cellsX) * m_cellsZ + 1 &&
+                                 m_cellStart.back() == m_triangleIndices.size()));
+    if (!valid) Clear();
+    return valid;
+}
+
+bool SpatialGrid::Validate(size_t triangleCount) const {
+    // Cell ranges must not run backwards, or a count underflows into a huge read
+    if (!m_cellStart.empty() && m_cellStart[0] != 0) return false;
+    for (size_t cell = 1; cell < m_cellStart.size(); cell++) {
+        if (m_cellStart[cell] < m_cellStart[cell - 1]) return false;
+    }
+    for (uint32_t triangle : m_triangleIndices) {
+        if (triangle >= triangleCount) return false;
+    }
+    return true;
+}
+
+void SpatialGrid::GetCellRange(const TerrainTriangle& tri, int& startX, int& endX, int& startZ, int& endZ) const {
+    float minX = std::min({tri.v0.x, tri.v1.x, tri.v2.x});
+    float maxX = std::max({tri.v0.x, tri.v1.x, tri.v2.x});
+    float minZ = std::min({tri.v0.z, tri.v1.z, tri.v2.z});
+    float maxZ = std::max({tri.v0.z, tri.v1.z, tri.v2.z});
+
+    // Same floor mapping as the query side, so a point always lands in a cell listing its triangle
+    startX = std::clamp(static_cast<int>(std::floor((minX - m_origin.x) * m_invCellSize)), 0, m_cellsX - 1);
+    endX =   std::clamp(static_cast<int>(std::floor((maxX - m_origin.x) * m_invCellSize)), 0, m_cellsX - 1);
+    startZ = std::clamp(static_cast<int>(std::floor((minZ - m_origin.y) * m_invCellSize)), 0, m_cellsZ - 1);
+    endZ =   std::clamp(static_cast<int>(std::floor((maxZ - m_origin.y) * m_invCellSize)), 0, m_cellsZ - 1);
+}
+
+static glm::vec3 SafeInverse(const glm::vec3& dir) {
+    // Avoid 0 * inf in the slab test for axis-aligned directions
+    auto inv = [](float d) { return 1.0f / (std::abs(d) < 1e-8f ? std::copysign(1e-8f, d) : d); };
+    return glm::vec3(inv(dir.x), inv(dir.y), inv(dir.z));
+}
+
+static bool IntersectRayAABB(const glm::vec3& origin, const glm::vec3& invDir,
+    const glm::vec3& boundsMin, const glm::vec3& boundsMax, float maxT, float& tEnter) {
+    glm::vec3 t0 = (boundsMin - origin) * invDir;
+    glm::vec3 t1 = (boundsMax - origin) * invDir;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    tEnter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float tExit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxT));
+    return tEnter <= tExit;
+}
+
+static bool IntersectRayTriangle(const glm::vec3& origin, const glm::vec3& dir,
+    const TerrainTriangle& tri, float& t) {
+    // Two-sided Moller-Trumbore
+    glm::vec3 edge1 = tri.v1 - tri.v0;
+    glm::vec3 edge2 = tri.v2 - tri.v0;
+    glm::vec3 p = glm::cross(dir, edge2);
+    float det = glm::dot(edge1, p);
+    if (std::abs(det) < 1e-8f) return false;
+
+    float invDet = 1.0f / det;
+    glm::vec3 s = origin - tri.v0;
+    float u = glm::dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f) return false;
+
+    glm::vec3 q = glm::cross(s, edge1);
+    float v = glm::dot(dir, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) return false;
+
+    t = glm::dot(edge2, q) * invDet;
+    return t >= 0.0f;
+}
+
+glm::vec3 ClosestPointOnTriangle(const glm::vec3& p, const TerrainTriangle& tri) {
+    // Voronoi region walk (Ericson, Real-Time Collision Detection 5.1.5)
+    const glm::vec3& a = tri.v0;
+    const glm::vec3& b = tri.v1;
+    const glm::vec3& c = tri.v2;
+    glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+
+    float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) return a;
+
+    glm::vec3 bp = p - b;
+    float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) return b;
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return a + ab * (d1 / (d1 - d3));
+
+    glm::vec3 cp = p - c;
+    float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) return c;
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return a + ac * (d2 / (d2 - d6));
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    float denom = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+static bool LowestRoot(float a, float b, float c, float maxT, float& root) {
+    float det = b * b - 4.0f * a * c;
+    if (det < 0.0f || std::abs(a) < 1e-12f) return false;
+
+    float sqrtDet = std::sqrt(det);
+    float r1 = (-b - sqrtDet) / (2.0f * a);
+    float r2 = (-b + sqrtDet) / (2.0f * a);
+    if (r1 > r2) std::swap(r1, r2);
+
+    if (r1 >= 0.0f && r1 < maxT) { root = r1; return true; }
+    if (r2 >= 0.0f && r2 < maxT) { root = r2; return true; }
+    return false;
+}
+
+static bool SweepSphereTriangle(const glm::vec3& from, const glm::vec3& d, float radius,
+    const TerrainTriangle& tri, float maxT, float& tHit, glm::vec3& contact) {
+    const float radiusSq = radius * radius;
+
+    // Already touching at the start of the sweep
+    glm::vec3 closest = ClosestPointOnTriangle(from, tri);
+    glm::vec3 offset = from - closest;
+    if (glm::dot(offset, offset) <= radiusSq) {
+        tHit = 0.0f;
+        contact = closest;
+        return true;
+    }
+
+    // Face: first time the sphere touches the triangle's plane inside the triangle
+    glm::vec3 normal = tri.normal;
+    float planeDist = glm::dot(from - tri.v0, normal);
+    if (planeDist < 0.0f) {
+        normal = -normal;
+        planeDist = -planeDist;
+    }
+    float approach = glm::dot(d, normal);
+    if (planeDist > radius && approach < 0.0f) {
+        float t = (radius - planeDist) / approach;
+        if (t < maxT) {
+            glm::vec3 planePoint = from + d * t - normal * radius;
+            glm::vec3 onTriangle = ClosestPointOnTriangle(planePoint, tri);
+            glm::vec3 error = planePoint - onTriangle;
+            if (glm::dot(error, error) < 1e-8f) {
+                tHit = t;
+                contact = planePoint;
+                return true;
+            }
+        }
+    }
+
+    // Otherwise the first contact is on a vertex or an edge
+    bool found = false;
+    float best = maxT;
+    const float dd = glm::dot(d, d);
+
+    const glm::vec3* vertices[3] = { &tri.v0, &tri.v1, &tri.v2 };
+    for (int i = 0; i < 3; i++) {
+        const glm::vec3& v = *vertices[i];
+        glm::vec3 toFrom = from - v;
+        float t;
+        if (LowestRoot(dd, 2.0f * glm::dot(d, toFrom), glm::dot(toFrom, toFrom) - radiusSq, best, t)) {
+            best = t;
+            contact = v;
+            found = true;
+        }
+    }
+
+    for (int i = 0; i < 3; i++) {
+        const glm::vec3& a = *vertices[i];
+        glm::vec3 edge = *vertices[(i + 1) % 3] - a;
+        glm::vec3 baseToVertex = a - from;
+        float edgeLenSq = glm::dot(edge, edge);
+        float edgeDotDir = glm::dot(edge, d);
+        float edgeDotBase = glm::dot(edge, baseToVertex);
+
+        float qa = edgeLenSq * -dd + edgeDotDir * edgeDotDir;
+        float qb = edgeLenSq * (2.0f * glm::dot(d, baseToVertex)) - 2.0f * edgeDotDir * edgeDotBase;
+        float qc = edgeLenSq * (radiusSq - glm::dot(baseToVertex, baseToVertex)) + edgeDotBase * edgeDotBase;
+
+        float t;
+        if (LowestRoot(qa, qb, qc, best, t)) {
+            float f = (edgeDotDir * t - edgeDotBase) / edgeLenSq;
+            if (f >= 0.0f && f <= 1.0f) {
+                best = t;
+                contact = a + edge * f;
+                found = true;
+            }
+        }
+    }
+
+    if (found) tHit = best;
+    return found;
+}
+
+void TerrainBVH::Build(const std::vector<TerrainTriangle>& triangles) {
+    Clear();
+    if (triangles.empty()) return;
+
+    std::vector<glm::vec3> centroids(triangles.size());
+    m_triangleOrder.resize(triangles.size());
+    for (size_t i = 0; i < triangles.size(); i++) {
+        centroids[i] = (triangles[i].v0 + triangles[i].v1 + triangles[i].v2) / 3.0f;
+        m_triangleOrder[i] = static_cast<uint32_t>(i);
+    }
+
+    m_nodes.reserve(2 * triangles.size());
+    m_nodes.push_back({glm::vec3(0.0f), 0, glm::vec3(0.0f), static_cast<uint32_t>(triangles.size())});
+    Subdivide(0, centroids, triangles);
+}
+
+void TerrainBVH::Clear() {
+    m_nodes.clear();
+    m_triangleOrder.clear();
+}
+
+void TerrainBVH::Serialize(TerrainBlobWriter& out) const {
+    out.WriteArray(m_nodes);
+    out.WriteArray(m_triangleOrder);
+}
+
+bool TerrainBVH::Deserialize(TerrainBlobReader& in) {
+    if (in.ReadArray(m_nodes) && in.ReadArray(m_triangleOrder)) return true;
+    Clear();
+    return false;
+}
+
+bool TerrainBVH::Validate(size_t triangleCount) const {
+    for (uint32_t triangle : m_triangleOrder) {
+        if (triangle >= triangleCount) return false;
+    }
+    if (m_nodes.empty()) return true;
+
+    // Walk the tree the way the queries do. Children always come after their parent,
+    // so there are no cycles, and the visited flags rule out shared subtrees.
+    std::vector<uint8_t> visited(m_nodes.size(), 0);
+    std::vector<std::pair<uint32_t, int>> pending = {{0, 1}};
+    while (!pending.empty()) {
+        const auto [index, depth] = pending.back();
+        pending.pop_back();
+        if (visited[index] || depth >= STACK_SIZE) return false;
+        visited[index] = 1;
+
+        const Node& node = m_nodes[index];
+        if (node.count > 0) {
+            if (static_cast<uint64_t>(node.leftFirst) + node.count > m_triangleOrder.size()) return false;
+            continue;
+        }
+        if (node.leftFirst <= index || static_cast<uint64_t>(node.leftFirst) + 1 >= m_nodes.size()) return false;
+        pending.push_back({node.leftFirst, depth + 1});
+        pending.push_back({node.leftFirst + 1, depth + 1});
+    }
+    return true;
+}
+
+void TerrainBVH::Subdivide(uint32_t nodeIndex, const std::vector<glm::vec3>& centroids,
+    const std::vector<TerrainTriangle>& triangles) {
+    const uint32_t first = m_nodes[nodeIndex].leftFirst;
+    const uint32_t count = m_nodes[nodeIndex].count;
+
+    // Fit bounds to the node's triangles
+    glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+    glm::vec3 centroidMin(FLT_MAX), centroidMax(-FLT_MAX);
+    for (uint32_t i = first; i < first + count; i++) {
+        const TerrainTriangle& tri = triangles[m_triangleOrder[i]];
+        boundsMin = glm::min(boundsMin, glm::min(tri.v0, glm::min(tri.v1, tri.v2)));
+        boundsMax = glm::max(boundsMax, glm::max(tri.v0, glm::max(tri.v1, tri.v2)));
+        centroidMin = glm::min(centroidMin, centroids[m_triangleOrder[i]]);
+        centroidMax = glm::max(centroidMax, centroids[m_triangleOrder[i]]);
+    }
+    m_nodes[nodeIndex].boundsMin = boundsMin;
+    m_nodes[nodeIndex].boundsMax = boundsMax;
+    if (count <= MAX_LEAF_SIZE) return;
+
+    // Median split along the widest centroid axis
+    glm::vec3 extent = centroidMax - centroidMin;
+    int axis = 0;
+    if (extent.y > extent[axis]) axis = 1;
+    if (extent.z > extent[axis]) axis = 2;
+    if (extent[axis] <= 0.0f) return;
+
+    const uint32_t mid = first + count / 2;
+    std::nth_element(m_triangleOrder.begin() + first, m_triangleOrder.begin() + mid,
+        m_triangleOrder.begin() + first + count,
+        [&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+
+    // Children are stored as an adjacent pair
+    const uint32_t leftIndex = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.push_back({glm::vec3(0.0f), first, glm::vec3(0.0f), mid - first});
+    m_nodes.push_back({glm::vec3(0.0f), mid, glm::vec3(0.0f), first + count - mid});
+    m_nodes[nodeIndex].leftFirst = leftIndex;
+    m_nodes[nodeIndex].count = 0;
+
+    Subdivide(leftIndex, centroids, triangles);
+    Subdivide(leftIndex + 1, centroids, triangles);
+}
+
+bool TerrainBVH::Raycast(const std::vector<TerrainTriangle>& triangles, const glm::vec3& origin,
+    const glm::vec3& dir, float maxDist, TerrainHit& hit) const {
+    if (m_nodes.empty()) return false;
+
+    const glm::vec3 invDir = SafeInverse(dir);
+    float closest = maxDist;
+    bool found = false;
+
+    uint32_t stack[STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const Node& node = m_nodes[stack[--stackSize]];
+        float tEnter;
+        if (!IntersectRayAABB(origin, invDir, node.boundsMin, node.boundsMax, closest, tEnter)) continue;
+
+        if (node.count > 0) {
+            for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+                float t;
+                if (IntersectRayTriangle(origin, dir, triangles[m_triangleOrder[i]], t) && t < closest) {
+                    closest = t;
+                    hit.triangle = m_triangleOrder[i];
+                    found = true;
+                }
+            }
+            continue;
+        }
+
+        // Visit the nearer child first
+        float tLeft, tRight;
+        const Node& left = m_nodes[node.leftFirst];
+        const Node& right = m_nodes[node.leftFirst + 1];
+        bool hitLeft = IntersectRayAABB(origin, invDir, left.boundsMin, left.boundsMax, closest, tLeft);
+        bool hitRight = IntersectRayAABB(origin, invDir, right.boundsMin, right.boundsMax, closest, tRight);
+        if (hitLeft && hitRight) {
+            bool leftFirst = tLeft <= tRight;
+            stack[stackSize++] = leftFirst ? node.leftFirst + 1 : node.leftFirst;
+            stack[stackSize++] = leftFirst ? node.leftFirst : node.leftFirst + 1;
+        } else if (hitLeft) {
+            stack[stackSize++] = node.leftFirst;
+        } else if (hitRight) {
+            stack[stackSize++] = node.leftFirst + 1;
+        }
+    }
+
+    if (!found) return false;
+
+    hit.distance = closest;
+    hit.time = maxDist > 0.0f ? closest / maxDist : 0.0f;
+    hit.point = origin + dir * closest;
+    hit.normal = triangles[hit.triangle].normal;
+    if (glm::dot(hit.normal, dir) > 0.0f) hit.normal = -hit.normal;
+    return true;
+}
+
+bool TerrainBVH::SweepSphere(const std::vector<TerrainTriangle>& triangles, const glm::vec3& from,
+    const glm::vec3& to, float radius, TerrainHit& hit) const {
+    if (m_nodes.empty()) return false;
+
+    // Parametrise the sweep over t in [0, 1]
+    const glm::vec3 d = to - from;
+    const glm::vec3 invDir = SafeInverse(d);
+    const glm::vec3 pad(radius);
+    float closest = 1.0f;
+    glm::vec3 contact(0.0f);
+    bool found = false;
+
+    uint32_t stack[STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const Node& node = m_nodes[stack[--stackSize]];
+        float tEnter;
+        if (!IntersectRayAABB(from, invDir, node.boundsMin - pad, node.boundsMax + pad, closest, tEnter)) continue;
+
+        if (node.count > 0) {
+            for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+                float t;
+                glm::vec3 point;
+                if (SweepSphereTriangle(from, d, radius, triangles[m_triangleOrder[i]], closest, t, point)
+                    && (!found || t < closest)) {
+                    closest = t;
+                    contact = point;
+                    hit.triangle = m_triangleOrder[i];
+                    found = true;
+                }
+            }
+            continue;
+        }
+
+        stack[stackSize++] = node.leftFirst + 1;
+        stack[stackSize++] = node.leftFirst;
+    }
+
+    if (!found) return false;
+
+    glm::vec3 center = from + d * closest;
+    glm::vec3 away = center - contact;
+    float awayLength = glm::length(away);
+
+    hit.time = closest;
+    hit.distance = glm::length(d) * closest;
+    hit.point = contact;
+    hit.upNormal = triangles[hit.triangle].normal.y < 0.0f ? -triangles[hit.triangle].normal : triangles[hit.triangle].normal;
+    if (awayLength > 1e-6f) {
+        hit.normal = away / awayLength;
+    } else {
+        hit.normal = triangles[hit.triangle].normal;
+        if (glm::dot(hit.normal, d) > 0.0f) hit.normal = -hit.normal;
+    }
+    return true;
+}
+
+bool TerrainBVH::FindClosest(const std::vector<TerrainTriangle>& triangles, const glm::vec3& p, float maxDist,
+    glm::vec3& closest, uint32_t& triangle) const {
+    if (m_nodes.empty()) return false;
+
+    float bestDistSq = maxDist * maxDist;
+    bool found = false;
+
+    uint32_t stack[STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const Node& node = m_nodes[stack[--stackSize]];
+        glm::vec3 nearest = glm::clamp(p, node.boundsMin, node.boundsMax);
+        if (glm::dot(nearest - p, nearest - p) > bestDistSq) continue;
+
+        if (node.count > 0) {
+            for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+                glm::vec3 point = ClosestPointOnTriangle(p, triangles[m_triangleOrder[i]]);
+                float distSq = glm::dot(point - p, point - p);
+                if (distSq <= bestDistSq) {
+                    bestDistSq = distSq;
+                    closest = point;
+                    triangle = m_triangleOrder[i];
+                    found = true;
+                }
+            }
+            continue;
+        }
+
+        stack[stackSize++] = node.leftFirst + 1;
+        stack[stackSize++] = node.leftFirst;
+    }
+    return found;
+}
+
+void Heightfield::Build(const glm::vec2& minBounds, const glm::vec2& maxBounds, float resolution,
+    const std::function<TerrainSample(float, float)>& sampleTerrain, ThreadPool* pool) {
+    Clear();
+    if (resolution <= 0.0f || maxBounds.x <= minBounds.x || maxBounds.y <= minBounds.y) return;
+
+    m_minBounds = minBounds;
+    m_maxBounds = maxBounds;
+    m_spacing = 1.0f / resolution;
+    m_invSpacing = resolution;
+
+    const glm::vec2 extent = maxBounds - minBounds;
+    m_width = static_cast<int>(std::ceil(extent.x * m_invSpacing)) + 1;
+    m_depth = static_cast<int>(std::ceil(extent.y * m_invSpacing)) + 1;
+    m_heights.resize(static_cast<size_t>(m_width) * m_depth);
+    m_triangleIds.resize(m_heights.size());
+
+    // Keep the last row/column on the mesh so edge samples still hit a triangle
+    const float inset = 0.001f;
+    ForEachBlock(pool, m_depth, 16, [&](int firstRow, int lastRow) {
+        for (int z = firstRow; z < lastRow; z++) {
+            float worldZ = std::clamp(minBounds.y + z * m_spacing, minBounds.y + inset, maxBounds.y - inset);
+            for (int x = 0; x < m_width; x++) {
+                float worldX = std::clamp(minBounds.x + x * m_spacing, minBounds.x + inset, maxBounds.x - inset);
+                TerrainSample sample = sampleTerrain(worldX, worldZ);
+                m_heights[static_cast<size_t>(z) * m_width + x] = sample.height;
+                m_triangleIds[static_cast<size_t>(z) * m_width + x] = sample.triangle;
+            }
+        }
+    });
+}
+
+void Heightfield::Clear() {
+    m_heights.clear();
+    m_triangleIds.clear();
+    m_width = 0;
+    m_depth = 0;
+}
+
+void Heightfield::Serialize(TerrainBlobWriter& out) const {
+    out.Write(m_minBounds);
+    out.Write(m_maxBounds);
+    out.Write(m_spacing);
+    out.Write(m_width);
+    out.Write(m_depth);
+    out.WriteArray(m_heights);
+    out.WriteArray(m_triangleIds);
+}
+
+bool Heightfield::Deserialize(TerrainBlobReader& in) {
+    Clear();
+    if (!in.Read(m_minBounds) || !in.Read(m_maxBounds) || !in.Read(m_spacing) || !in.Read(m_width) ||
+        !in.Read(m_depth) || !in.ReadArray(m_heights) || !in.ReadArray(m_triangleIds)) {
+        Clear();
+        return false;
+    }
+    m_invSpacing = 1.0f / m_spacing;
+
+    bool valid = m_heights.empty() || (m_width >= 2 && m_depth >= 2 && m_spacing > 0.0f &&
+        m_heights.size() == static_cast<size_t>(m_width) * m_depth && m_triangleIds.size() == m_heights.size());
+    if (!valid) Clear();
+    return valid;
+}
+
+bool Heightfield::Validate(size_t triangleCount) const {
+    for (uint32_t triangle : m_triangleIds) {
+        if (triangle != TerrainSample::NO_TRIANGLE && triangle >= triangleCount) return false;
+    }
+    return true;
+}
+
+float Heightfield::GetHeight(float x, float z) const {
+    if (m_heights.empty()) return NO_TERRAIN;
+    if (x < m_minBounds.x || x > m_maxBounds.x || z < m_minBounds.y || z > m_maxBounds.y) return NO_TERRAIN;
+
+    // Continuous grid coordinates
+    float gx = (x - m_minBounds.x) * m_invSpacing;
+    float gz = (z - m_minBounds.y) * m_invSpacing;
+    int x0 = std::min(static_cast<int>(gx), m_width - 2);
+    int z0 = std::min(static_cast<int>(gz), m_depth - 2);
+    float fx = gx - x0;
+    float fz = gz - z0;
+
+    const float* row0 = &m_heights[static_cast<size_t>(z0) * m_width + x0];
+    const float* row1 = row0 + m_width;
+
+    float h0 = row0[0] + (row0[1] - row0[0]) * fx;
+    float h1 = row1[0] + (row1[1] - row1[0]) * fx;
+    return h0 + (h1 - h0) * fz;
+}
+
+float Heightfield::GetHeightAndTriangle(float x, float z, uint32_t& triangle) const {
+    triangle = TerrainSample::NO_TRIANGLE;
+    if (m_heights.empty()) return NO_TERRAIN;
+    if (x < m_minBounds.x || x > m_maxBounds.x || z < m_minBounds.y || z > m_maxBounds.y) return NO_TERRAIN;
+
+    float gx = (x - m_minBounds.x) * m_invSpacing;
+    float gz = (z - m_minBounds.y) * m_invSpacing;
+    int x0 = std::min(static_cast<int>(gx), m_width - 2);
+    int z0 = std::min(static_cast<int>(gz), m_depth - 2);
+    float fx = gx - x0;
+    float fz = gz - z0;
+
+    size_t index = static_cast<size_t>(z0) * m_width + x0;
+    const float* row0 = &m_heights[index];
+    const float* row1 = row0 + m_width;
+
+    // Nearest of the four corners
+    triangle = m_triangleIds[index + (fz >= 0.5f ? m_width : 0) + (fx >= 0.5f ? 1 : 0)];
+
+    float h0 = row0[0] + (row0[1] - row0[0]) * fx;
+    float h1 = row1[0] + (row1[1] - row1[0]) * fx;
+    return h0 + (h1 - h0) * fz;
+}
+
+float Heightfield::GetCoveredHeight(float x, float z) const {
+    if (m_heights.empty()) return NO_TERRAIN;
+    if (x < m_minBounds.x || x > m_maxBounds.x || z < m_minBounds.y || z > m_maxBounds.y) return NO_TERRAIN;
+
+    float gx = (x - m_minBounds.x) * m_invSpacing;
+    float gz = (z - m_minBounds.y) * m_invSpacing;
+    int x0 = std::min(static_cast<int>(gx), m_width - 2);
+    int z0 = std::min(static_cast<int>(gz), m_depth - 2);
+    float fx = gx - x0;
+    float fz = gz - z0;
+
+    const float* row0 = &m_heights[static_cast<size_t>(z0) * m_width + x0];
+    const float* row1 = row0 + m_width;
+
+    // Only corners with a non-zero weight count, so samples on the grid lines keep their edge
+    if ((row0[0] == NO_TERRAIN && fx < 1.0f && fz < 1.0f) || (row0[1] == NO_TERRAIN && fx > 0.0f && fz < 1.0f) ||
+        (row1[0] == NO_TERRAIN && fx < 1.0f && fz > 0.0f) || (row1[1] == NO_TERRAIN && fx > 0.0f && fz > 0.0f)) {
+        return NO_TERRAIN;
+    }
+
+    float h0 = row0[0] + (row0[1] - row0[0]) * fx;
+    float h1 = row1[0] + (row1[1] - row1[0]) * fx;
+    return h0 + (h1 - h0) * fz;
+}
+
+uint32_t Heightfield::GetTriangle(float x, float z) const {
+    if (m_heights.empty()) return TerrainSample::NO_TRIANGLE;
+    if (x < m_minBounds.x || x > m_maxBounds.x || z < m_minBounds.y || z > m_maxBounds.y) return TerrainSample::NO_TRIANGLE;
+
+    float gx = (x - m_minBounds.x) * m_invSpacing;
+    float gz = (z - m_minBounds.y) * m_invSpacing;
+    int x0 = std::min(static_cast<int>(gx), m_width - 2);
+    int z0 = std::min(static_cast<int>(gz), m_depth - 2);
+    size_t index = static_cast<size_t>(z0) * m_width + x0;
+    return m_triangleIds[index + (gz - z0 >= 0.5f ? m_width : 0) + (gx - x0 >= 0.5f ? 1 : 0)];
+}
+
+void Heightfield::GetHeights(const glm::vec2* xz, float* out, size_t count) const {
+    size_t i = 0;
+    if (m_heights.empty()) {
+        std::fill(out, out + count, NO_TERRAIN);
+        return;
+    }
+
+#if defined(__AVX2__)
+    // 8 points per iteration, corners fetched with hardware gathers
+    const __m256 minX = _mm256_set1_ps(m_minBounds.x), maxX = _mm256_set1_ps(m_maxBounds.x);
+    const __m256 minZ = _mm256_set1_ps(m_minBounds.y), maxZ = _mm256_set1_ps(m_maxBounds.y);
+    const __m256 invSpacing = _mm256_set1_ps(m_invSpacing);
+    const __m256 lastX = _mm256_set1_ps(static_cast<float>(m_width - 2));
+    const __m256 lastZ = _mm256_set1_ps(static_cast<float>(m_depth - 2));
+    const __m256 noTerrain = _mm256_set1_ps(NO_TERRAIN);
+    const __m256i width = _mm256_set1_epi32(m_width);
+    const __m256i permute = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+    for (; i + 8 <= count; i += 8) {
+        // Deinterleave x0 z0 x1 z1 ... into x and z lanes
+        __m256 a = _mm256_loadu_ps(&xz[i].x);
+        __m256 b = _mm256_loadu_ps(&xz[i + 4].x);
+        a = _mm256_permutevar8x32_ps(a, permute);
+        b = _mm256_permutevar8x32_ps(b, permute);
+        __m256 x = _mm256_permute2f128_ps(a, b, 0x20);
+        __m256 z = _mm256_permute2f128_ps(a, b, 0x31);
+
+        __m256 inside = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(x, minX, _CMP_GE_OQ), _mm256_cmp_ps(x, maxX, _CMP_LE_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(z, minZ, _CMP_GE_OQ), _mm256_cmp_ps(z, maxZ, _CMP_LE_OQ)));
+
+        __m256 gx = _mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(x, minX), invSpacing), _mm256_setzero_ps());
+        __m256 gz = _mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(z, minZ), invSpacing), _mm256_setzero_ps());
+        __m256 x0 = _mm256_min_ps(_mm256_floor_ps(gx), lastX);
+        __m256 z0 = _mm256_min_ps(_mm256_floor_ps(gz), lastZ);
+        __m256 fx = _mm256_min_ps(_mm256_sub_ps(gx, x0), _mm256_set1_ps(1.0f));
+        __m256 fz = _mm256_min_ps(_mm256_sub_ps(gz, z0), _mm256_set1_ps(1.0f));
+
+        __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_cvttps_epi32(z0), width), _mm256_cvttps_epi32(x0));
+        __m256 h00 = _mm256_i32gather_ps(m_heights.data(), index, 4);
+        __m256 h10 = _mm256_i32gather_ps(m_heights.data() + 1, index, 4);
+        __m256 h01 = _mm256_i32gather_ps(m_heights.data() + m_width, index, 4);
+        __m256 h11 = _mm256_i32gather_ps(m_heights.data() + m_width + 1, index, 4);
+
+        __m256 h0 = _mm256_add_ps(h00, _mm256_mul_ps(_mm256_sub_ps(h10, h00), fx));
+        __m256 h1 = _mm256_add_ps(h01, _mm256_mul_ps(_mm256_sub_ps(h11, h01), fx));
+        __m256 h = _mm256_add_ps(h0, _mm256_mul_ps(_mm256_sub_ps(h1, h0), fz));
+        _mm256_storeu_ps(out + i, _mm256_blendv_ps(noTerrain, h, inside));
+    }
+#elif defined(TERRAIN_SIMD_SSE2)
+    // 4 points per iteration, SSE2 has no gather so the corners are loaded per lane
+    const __m128 minX = _mm_set1_ps(m_minBounds.x), maxX = _mm_set1_ps(m_maxBounds.x);
+    const __m128 minZ = _mm_set1_ps(m_minBounds.y), maxZ = _mm_set1_ps(m_maxBounds.y);
+    const __m128 invSpacing = _mm_set1_ps(m_invSpacing);
+    const __m128 lastX = _mm_set1_ps(static_cast<float>(m_width - 2));
+    const __m128 lastZ = _mm_set1_ps(static_cast<float>(m_depth - 2));
+    const __m128 noTerrain = _mm_set1_ps(NO_TERRAIN);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 a = _mm_loadu_ps(&xz[i].x);
+        __m128 b = _mm_loadu_ps(&xz[i + 2].x);
+        __m128 x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 z = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+
+        __m128 inside = _mm_and_ps(
+            _mm_and_ps(_mm_cmpge_ps(x, minX), _mm_cmple_ps(x, maxX)),
+            _mm_and_ps(_mm_cmpge_ps(z, minZ), _mm_cmple_ps(z, maxZ)));
+
+        // Clamped to the grid so outside lanes still read valid memory
+        __m128 gx = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(x, minX), invSpacing), _mm_setzero_ps());
+        __m128 gz = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(z, minZ), invSpacing), _mm_setzero_ps());
+        __m128i x0i = _mm_cvttps_epi32(_mm_min_ps(gx, lastX));
+        __m128i z0i = _mm_cvttps_epi32(_mm_min_ps(gz, lastZ));
+        __m128 fx = _mm_min_ps(_mm_sub_ps(gx, _mm_cvtepi32_ps(x0i)), _mm_set1_ps(1.0f));
+        __m128 fz = _mm_min_ps(_mm_sub_ps(gz, _mm_cvtepi32_ps(z0i)), _mm_set1_ps(1.0f));
+
+        alignas(16) int32_t cx[4], cz[4];
+        alignas(16) float c00[4], c10[4], c01[4], c11[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(cx), x0i);
+        _mm_store_si128(reinterpret_cast<__m128i*>(cz), z0i);
+        for (int lane = 0; lane < 4; lane++) {
+            const float* row0 = &m_heights[static_cast<size_t>(cz[lane]) * m_width + cx[lane]];
+            c00[lane] = row0[0];
+            c10[lane] = row0[1];
+            c01[lane] = row0[m_width];
+            c11[lane] = row0[m_width + 1];
+        }
+
+        __m128 h00 = _mm_load_ps(c00), h10 = _mm_load_ps(c10);
+        __m128 h01 = _mm_load_ps(c01), h11 = _mm_load_ps(c11);
+        __m128 h0 = _mm_add_ps(h00, _mm_mul_ps(_mm_sub_ps(h10, h00), fx));
+        __m128 h1 = _mm_add_ps(h01, _mm_mul_ps(_mm_sub_ps(h11, h01), fx));
+        __m128 h = _mm_add_ps(h0, _mm_mul_ps(_mm_sub_ps(h1, h0), fz));
+        _mm_storeu_ps(out + i, _mm_or_ps(_mm_and_ps(inside, h), _mm_andnot_ps(inside, noTerrain)));
+    }
+#endif
+
+    for (; i < count; i++) {
+        out[i] = GetHeight(xz[i].x, xz[i].y);
+    }
+}
+
+void TerrainCollision::GetHeightsFromGrid(const glm::vec2* xz, float* out, size_t count) const {
+    for (size_t p = 0; p < count; p++) {
+        const float x = xz[p].x;
+        const float z = xz[p].y;
+        uint32_t cellCount;
+        const uint32_t* cell = grid.GetTrianglesAt(x, z, cellCount);
+        float maxHeight = -FLT_MAX;
+        uint32_t t = 0;
+
+#ifdef TERRAIN_SIMD_SSE2
+        // 4 triangles per iteration: barycentric coordinates in XZ, then interpolate Y
+        const __m128 px = _mm_set1_ps(x), pz = _mm_set1_ps(z);
+        const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+        const __m128 epsilon = _mm_set1_ps(1e-8f);
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        __m128 best = _mm_set1_ps(-FLT_MAX);
+
+        for (; t < cellCount; t += 4) {
+            // Pad the last group by repeating its final triangle, max() ignores duplicates
+            const TerrainTriangle* tri[4];
+            for (int lane = 0; lane < 4; lane++) {
+                tri[lane] = &triangles[cell[std::min(t + lane, cellCount - 1)]];
+            }
+
+            __m128 ax = _mm_setr_ps(tri[0]->v0.x, tri[1]->v0.x, tri[2]->v0.x, tri[3]->v0.x);
+            __m128 ay = _mm_setr_ps(tri[0]->v0.y, tri[1]->v0.y, tri[2]->v0.y, tri[3]->v0.y);
+            __m128 az = _mm_setr_ps(tri[0]->v0.z, tri[1]->v0.z, tri[2]->v0.z, tri[3]->v0.z);
+            __m128 e0x = _mm_sub_ps(_mm_setr_ps(tri[0]->v1.x, tri[1]->v1.x, tri[2]->v1.x, tri[3]->v1.x), ax);
+            __m128 e0y = _mm_sub_ps(_mm_setr_ps(tri[0]->v1.y, tri[1]->v1.y, tri[2]->v1.y, tri[3]->v1.y), ay);
+            __m128 e0z = _mm_sub_ps(_mm_setr_ps(tri[0]->v1.z, tri[1]->v1.z, tri[2]->v1.z, tri[3]->v1.z), az);
+            __m128 e1x = _mm_sub_ps(_mm_setr_ps(tri[0]->v2.x, tri[1]->v2.x, tri[2]->v2.x, tri[3]->v2.x), ax);
+            __m128 e1y = _mm_sub_ps(_mm_setr_ps(tri[0]->v2.y, tri[1]->v2.y, tri[2]->v2.y, tri[3]->v2.y), ay);
+            __m128 e1z = _mm_sub_ps(_mm_setr_ps(tri[0]->v2.z, tri[1]->v2.z, tri[2]->v2.z, tri[3]->v2.z), az);
+            __m128 dx = _mm_sub_ps(px, ax);
+            __m128 dz = _mm_sub_ps(pz, az);
+
+            __m128 den = _mm_sub_ps(_mm_mul_ps(e0x, e1z), _mm_mul_ps(e1x, e0z));
+            __m128 valid = _mm_cmpgt_ps(_mm_and_ps(den, absMask), epsilon);
+            __m128 invDen = _mm_div_ps(one, _mm_or_ps(_mm_and_ps(valid, den), _mm_andnot_ps(valid, one)));
+            __m128 u = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(dx, e1z), _mm_mul_ps(dz, e1x)), invDen);
+            __m128 v = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(dz, e0x), _mm_mul_ps(dx, e0z)), invDen);
+
+            __m128 inside = _mm_and_ps(valid, _mm_and_ps(
+                _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmpge_ps(v, zero)),
+                _mm_cmple_ps(_mm_add_ps(u, v), one)));
+            __m128 height = _mm_add_ps(ay, _mm_add_ps(_mm_mul_ps(u, e0y), _mm_mul_ps(v, e1y)));
+            best = _mm_max_ps(best, _mm_or_ps(_mm_and_ps(inside, height), _mm_andnot_ps(inside, best)));
+        }
+
+        // Horizontal max
+        best = _mm_max_ps(best, _mm_shuffle_ps(best, best, _MM_SHUFFLE(2, 3, 0, 1)));
+        best = _mm_max_ps(best, _mm_shuffle_ps(best, best, _MM_SHUFFLE(1, 0, 3, 2)));
+        maxHeight = _mm_cvtss_f32(best);
+#else
+        for (; t < cellCount; t++) {
+            const TerrainTriangle& tri = triangles[cell[t]];
+            glm::vec2 e0(tri.v1.x - tri.v0.x, tri.v1.z - tri.v0.z);
+            glm::vec2 e1(tri.v2.x - tri.v0.x, tri.v2.z - tri.v0.z);
+            glm::vec2 d(x - tri.v0.x, z - tri.v0.z);
+            float den = e0.x * e1.y - e1.x * e0.y;
+            if (std::abs(den) <= 1e-8f) continue;
+            float u = (d.x * e1.y - d.y * e1.x) / den;
+            float v = (d.y * e0.x - d.x * e0.y) / den;
+            if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f) {
+                maxHeight = std::max(maxHeight, tri.v0.y + u * (tri.v1.y - tri.v0.y) + v * (tri.v2.y - tri.v0.y));
+            }
+        }
+#endif
+
+        out[p] = maxHeight > -FLT_MAX ? maxHeight : Heightfield::NO_TERRAIN;
+    }
+}
+
+void HeightPyramid::Build(const std::vector<TerrainTriangle>& triangles, float cellSize) {
+    Clear();
+    if (triangles.empty() || cellSize <= 0.0f) return;
+
+    glm::vec2 minBounds(FLT_MAX);
+    glm::vec2 maxBounds(-FLT_MAX);
+    for (const TerrainTriangle& tri : triangles) {
+        minBounds = glm::min(minBounds, glm::vec2(std::min({tri.v0.x, tri.v1.x, tri.v2.x}),
+                                                  std::min({tri.v0.z, tri.v1.z, tri.v2.z})));
+        maxBounds = glm::max(maxBounds, glm::vec2(std::max({tri.v0.x, tri.v1.x, tri.v2.x}),
+                                                  std::max({tri.v0.z, tri.v1.z, tri.v2.z})));
+    }
+
+    m_origin = minBounds;
+    m_cellSize = cellSize;
+    m_invCellSize = 1.0f / cellSize;
+
+    // Level layout down to a single cell
+    int width = static_cast<int>(std::floor((maxBounds.x - minBounds.x) * m_invCellSize)) + 1;
+    int depth = static_cast<int>(std::floor((maxBounds.y - minBounds.y) * m_invCellSize)) + 1;
+    uint32_t cellCount = 0;
+    while (true) {
+        m_levels.push_back({width, depth, cellCount});
+        cellCount += static_cast<uint32_t>(width) * depth;
+        if (width == 1 && depth == 1) break;
+        width = (width + 1) / 2;
+        depth = (depth + 1) / 2;
+    }
+    m_cellBounds.assign(cellCount, glm::vec2(FLT_MAX, -FLT_MAX));
+
+    // Base level: every triangle widens the range of each cell its XZ bounds touch
+    const Level& base = m_levels[0];
+    for (const TerrainTriangle& tri : triangles) {
+        int startX = static_cast<int>(std::floor((std::min({tri.v0.x, tri.v1.x, tri.v2.x}) - m_origin.x) * m_invCellSize));
+        int endX   = static_cast<int>(std::floor((std::max({tri.v0.x, tri.v1.x, tri.v2.x}) - m_origin.x) * m_invCellSize));
+        int startZ = static_cast<int>(std::floor((std::min({tri.v0.z, tri.v1.z, tri.v2.z}) - m_origin.y) * m_invCellSize));
+        int endZ   = static_cast<int>(std::floor((std::max({tri.v0.z, tri.v1.z, tri.v2.z}) - m_origin.y) * m_invCellSize));
+        startX = std::max(startX, 0);
+        startZ = std::max(startZ, 0);
+        endX = std::min(endX, base.width - 1);
+        endZ = std::min(endZ, base.depth - 1);
+
+        float minY = std::min({tri.v0.y, tri.v1.y, tri.v2.y});
+        float maxY = std::max({tri.v0.y, tri.v1.y, tri.v2.y});
+        for (int z = startZ; z <= endZ; z++) {
+            for (int x = startX; x <= endX; x++) {
+                glm::vec2& bounds = m_cellBounds[static_cast<size_t>(z) * base.width + x];
+                bounds.x = std::min(bounds.x, minY);
+                bounds.y = std::max(bounds.y, maxY);
+            }
+        }
+    }
+
+    // Each coarser cell covers up to 2x2 cells of the level below
+    for (size_t level = 1; level < m_levels.size(); level++) {
+        const Level& fine = m_levels[level - 1];
+        const Level& coarse = m_levels[level];
+        for (int z = 0; z < fine.depth; z++) {
+            for (int x = 0; x < fine.width; x++) {
+                const glm::vec2& src = m_cellBounds[fine.offset + static_cast<size_t>(z) * fine.width + x];
+                glm::vec2& dst = m_cellBounds[coarse.offset + static_cast<size_t>(z / 2) * coarse.width + x / 2];
+                dst.x = std::min(dst.x, src.x);
+                dst.y = std::max(dst.y, src.y);
+            }
+        }
+    }
+}
+
+void HeightPyramid::Clear() {
+    m_levels.clear();
+    m_cellBounds.clear();
+}
+
+void HeightPyramid::Serialize(TerrainBlobWriter& out) const {
+    out.Write(m_origin);
+    out.Write(m_cellSize);
+    out.WriteArray(m_levels);
+    out.WriteArray(m_cellBounds);
+}
+
+bool HeightPyramid::Deserialize(TerrainBlobReader& in) {
+    Clear();
+    if (!in.Read(m_origin) || !in.Read(m_cellSize) || !in.ReadArray(m_levels) || !in.ReadArray(m_cellBounds)) {
+        Clear();
+        return false;
+    }
+    m_invCellSize = 1.0f / m_cellSize;
+
+    bool valid = m_cellSize > 0.0f;
+    for (const Level& level : m_levels) {
+        valid = valid && level.width > 0 && level.depth > 0 &&
+            level.offset + static_cast<size_t>(level.width) * level.depth <= m_cellBounds.size();
+    }
+    if (!valid) Clear();
+    return valid;
+}
+
+bool HeightPyramid::IsAbove(const glm::vec2& minXZ, const glm::vec2& maxXZ, float y) const {
+    if (m_levels.empty()) return false;
+
+    // Start at the coarsest level and refine while the footprint stays within 2x2 cells
+    for (size_t i = m_levels.size(); i-- > 0;) {
+        const Level& level = m_levels[i];
+        const float invSize = m_invCellSize / static_cast<float>(1 << i);
+        int startX = static_cast<int>(std::floor((minXZ.x - m_origin.x) * invSize));
+        int endX   = static_cast<int>(std::floor((maxXZ.x - m_origin.x) * invSize));
+        int startZ = static_cast<int>(std::floor((minXZ.y - m_origin.y) * invSize));
+        int endZ   = static_cast<int>(std::floor((maxXZ.y - m_origin.y) * invSize));
+
+        // Entirely off the map, nothing to hit
+        if (endX < 0 || endZ < 0 || startX >= level.width || startZ >= level.depth) return true;
+        startX = std::max(startX, 0);
+        startZ = std::max(startZ, 0);
+        endX = std::min(endX, level.width - 1);
+        endZ = std::min(endZ, level.depth - 1);
+        if ((endX - startX) > 1 || (endZ - startZ) > 1) return false;
+
+        float maxHeight = -FLT_MAX;
+        for (int z = startZ; z <= endZ; z++) {
+            for (int x = startX; x <= endX; x++) {
+                maxHeight = std::max(maxHeight, m_cellBounds[level.offset + static_cast<size_t>(z) * level.width + x].y);
+            }
+        }
+        if (y > maxHeight) return true;
+    }
+    return false;
+}
+
+void TerrainDistanceField::Build(const std::vector<TerrainTriangle>& triangles, const TerrainBVH& bvh,
+    float spacing, float band, ThreadPool* pool) {
+    Clear();
+    if (triangles.empty() || bvh.IsEmpty() || spacing <= 0.0f || band <= 0.0f) return;
+
+    m_terrainMin = glm::vec3(FLT_MAX);
+    m_terrainMax = glm::vec3(-FLT_MAX);
+    for (const TerrainTriangle& tri : triangles) {
+        m_terrainMin = glm::min(m_terrainMin, glm::min(tri.v0, glm::min(tri.v1, tri.v2)));
+        m_terrainMax = glm::max(m_terrainMax, glm::max(tri.v0, glm::max(tri.v1, tri.v2)));
+    }
+
+    // Lattice covers the mesh plus the band on every side
+    m_origin = m_terrainMin - glm::vec3(band);
+    m_spacing = spacing;
+    m_invSpacing = 1.0f / spacing;
+    m_halfDiagonal = 0.5f * spacing * std::sqrt(3.0f);
+    const glm::vec3 extent = (m_terrainMax + glm::vec3(band)) - m_origin;
+    m_sizeX = static_cast<int>(std::ceil(extent.x * m_invSpacing)) + 1;
+    m_sizeY = static_cast<int>(std::ceil(extent.y * m_invSpacing)) + 1;
+    m_sizeZ = static_cast<int>(std::ceil(extent.z * m_invSpacing)) + 1;
+    m_distances.resize(static_cast<size_t>(m_sizeX) * m_sizeY * m_sizeZ);
+
+    // Slices along z are independent
+    ForEachBlock(pool, m_sizeZ, 1, [&](int firstSlice, int lastSlice) {
+        for (int z = firstSlice; z < lastSlice; z++) {
+            for (int y = 0; y < m_sizeY; y++) {
+                for (int x = 0; x < m_sizeX; x++) {
+                    glm::vec3 p = m_origin + glm::vec3(x, y, z) * spacing;
+                    glm::vec3 closest;
+                    uint32_t triangle;
+                    float distance;
+                    if (bvh.FindClosest(triangles, p, band, closest, triangle)) {
+                        // Sign from the side of the nearest triangle, the terrain normals face up
+                        distance = glm::length(p - closest);
+                        if (glm::dot(p - closest, triangles[triangle].normal) < 0.0f) distance = -distance;
+                    } else {
+                        distance = p.y < m_terrainMin.y ? -band : band;
+                    }
+                    m_distances[(static_cast<size_t>(z) * m_sizeY + y) * m_sizeX + x] = distance;
+                }
+            }
+        }
+    });
+}
+
+void TerrainDistanceField::Clear() {
+    m_distances.clear();
+    m_sizeX = 0;
+    m_sizeY = 0;
+    m_sizeZ = 0;
+}
+
+void TerrainDistanceField::Serialize(TerrainBlobWriter& out) const {
+    out.Write(m_origin);
+    out.Write(m_terrainMin);
+    out.Write(m_terrainMax);
+    out.Write(m_spacing);
+    out.Write(m_sizeX);
+    out.Write(m_sizeY);
+    out.Write(m_sizeZ);
+    out.WriteArray(m_distances);
+}
+
+bool TerrainDistanceField::Deserialize(TerrainBlobReader& in) {
+    Clear();
+    if (!in.Read(m_origin) || !in.Read(m_terrainMin) || !in.Read(m_terrainMax) || !in.Read(m_spacing) ||
+        !in.Read(m_sizeX) || !in.Read(m_sizeY) || !in.Read(m_sizeZ) || !in.ReadArray(m_distances)) {
+        Clear();
+        return false;
+    }
+    m_invSpacing = 1.0f / m_spacing;
+    m_halfDiagonal = 0.5f * m_spacing * std::sqrt(3.0f);
+
+    bool valid = m_distances.empty() || (m_spacing > 0.0f && m_sizeX > 0 && m_sizeY > 0 && m_sizeZ > 0 &&
+        m_distances.size() == static_cast<size_t>(m_sizeX) * m_sizeY * m_sizeZ);
+    if (!valid) Clear();
+    return valid;
+}
+
+float TerrainDistanceField::GetDistanceBound(const glm::vec3& p) const {
+    // Nothing is closer than the mesh bounds
+    glm::vec3 outside = glm::max(glm::max(m_terrainMin - p, p - m_terrainMax), glm::vec3(0.0f));
+    float boxDistance = glm::length(outside);
+    if (m_distances.empty()) return boxDistance;
+
+    glm::vec3 g = (p - m_origin) * m_invSpacing;
+    if (g.x < 0.0f || g.y < 0.0f || g.z < 0.0f ||
+        g.x > m_sizeX - 1 || g.y > m_sizeY - 1 || g.z > m_sizeZ - 1) {
+        return boxDistance;
+    }
+
+    // The field is 1-Lipschitz, so the nearest node bounds the distance here
+    int x = static_cast<int>(g.x + 0.5f);
+    int y = static_cast<int>(g.y + 0.5f);
+    int z = static_cast<int>(g.z + 0.5f);
+    float nodeDistance = std::abs(m_distances[(static_cast<size_t>(z) * m_sizeY + y) * m_sizeX + x]);
+    return std::max(boxDistance, nodeDistance - m_halfDiagonal);
+}
+
+bool TerrainCollision::SweepSphere(const glm::vec3& from, const glm::vec3& to, float radius, TerrainHit& hit) const {
+    if (pyramid.IsAbove(from, to, radius)) return false;
+
+    // Step by the guaranteed clearance until the sphere might be touching something
+    const int MAX_TRACE_STEPS = 16;
+    const float CONTACT_CLEARANCE = 0.05f;
+    const glm::vec3 delta = to - from;
+    const float length = glm::length(delta);
+    float travelled = 0.0f;
+
+    if (!distanceField.IsEmpty() && length > 0.0f) {
+        const glm::vec3 dir = delta / length;
+        for (int step = 0; step < MAX_TRACE_STEPS; step++) {
+            float clearance = distanceField.GetDistanceBound(from + dir * travelled) - radius;
+            if (clearance <= CONTACT_CLEARANCE) break;
+            travelled += clearance;
+            if (travelled >= length) return false;
+        }
+    }
+
+    // Exact time of impact over whatever is left of the sweep
+    const glm::vec3 start = length > 0.0f ? from + delta * (travelled / length) : from;
+    if (!bvh.SweepSphere(triangles, start, to, radius, hit)) return false;
+    hit.distance += travelled;
+    hit.time = length > 0.0f ? hit.distance / length : 0.0f;
+    return true;
+}
+
+void TerrainCollision::Serialize(TerrainBlobWriter& out) const {
+    out.WriteArray(triangles);
+    grid.Serialize(out);
+    heightfield.Serialize(out);
+    bvh.Serialize(out);
+    pyramid.Serialize(out);
+    distanceField.Serialize(out);
+}
+
+bool TerrainCollision::Deserialize(TerrainBlobReader& in) {
+    if (!in.ReadArray(triangles) || !grid.Deserialize(in) || !heightfield.Deserialize(in) ||
+        !bvh.Deserialize(in) || !pyramid.Deserialize(in) || !distanceField.Deserialize(in)) {
+        return false;
+    }
+    // A corrupt or hand-edited file can carry any index, so none are trusted until checked
+    return grid.Validate(triangles.size()) && heightfield.Validate(triangles.size()) &&
+        bvh.Validate(triangles.size());
+}
+
+float TerrainCollision::GetHeightFromGrid(float x, float z) const {
+    // Only the cell under the point can hold triangles covering it
+    const glm::vec3 origin(x, 1000.0f, z);
+    const glm::vec3 dir(0.0f, -1.0f, 0.0f);
+    float maxHeight = -FLT_MAX;
+
+    grid.ForEachTriangleAt(x, z, [&](uint32_t triIndex) {
+        const TerrainTriangle& tri = triangles[triIndex];
+
+        // Perform precise ray-triangle intersection
+        float t = 0.0f;
+        glm::vec2 baryPosition; // Variable to store barycentric coordinates
+        if (glm::intersectRayTriangle(origin, dir, tri.v0, tri.v1, tri.v2, baryPosition, t)) {
+            float yHeight = origin.y + dir.y * t;
+            maxHeight = std::max(maxHeight, yHeight);
+        }
+    });
+
+    return maxHeight > -FLT_MAX ? maxHeight : Heightfield::NO_TERRAIN;
+}
+
+TerrainSample TerrainCollision::SampleFromGrid(float x, float z) const {
+    const glm::vec3 origin(x, 1000.0f, z);
+    const glm::vec3 dir(0.0f, -1.0f, 0.0f);
+    TerrainSample sample;
+    sample.height = -FLT_MAX;
+
+    // The topmost triangle under the point supplies both height and normal
+    grid.ForEachTriangleAt(x, z, [&](uint32_t triIndex) {
+        const TerrainTriangle& tri = triangles[triIndex];
+        float t = 0.0f;
+        glm::vec2 baryPosition;
+        if (glm::intersectRayTriangle(origin, dir, tri.v0, tri.v1, tri.v2, baryPosition, t)) {
+            float yHeight = origin.y + dir.y * t;
+            if (yHeight > sample.height) {
+                sample.height = yHeight;
+                sample.normal = tri.normal;
+                sample.triangle = triIndex;
+            }
+        }
+    });
+
+    if (sample.triangle == TerrainSample::NO_TRIANGLE) sample.height = Heightfield::NO_TERRAIN;
+    return sample;
+}
+
+TerrainSample TerrainCollision::SampleFromMap(float x, float z) const {
+    TerrainSample sample;
+    sample.height = heightfield.GetHeightAndTriangle(x, z, sample.triangle);
+    if (sample.triangle != TerrainSample::NO_TRIANGLE) {
+        sample.normal = triangles[sample.triangle].normal;
+    }
+    return sample;
+}
+
+glm::vec3 TerrainCollision::GetNormalFromGrid(float x, float z) const {
+    // Same topmost triangle the fused sample picks, so the two never disagree on overhangs
+    return SampleFromGrid(x, z).normal;
+}
+
+glm::vec3 TerrainCollision::GetNormalFromMap(float x, float z) const {
+    // The baked nearest-sample triangle, not the one under the point, to match SampleFromMap
+    uint32_t triangle = heightfield.GetTriangle(x, z);
+    return triangle != TerrainSample::NO_TRIANGLE ? triangles[triangle].normal : glm::vec3(0.0f, 1.0f, 0.0f);
+}
\ No newline at end of file
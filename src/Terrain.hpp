@@ -0,0 +1,329 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cmath>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "ThreadPool.hpp"
+
+struct TerrainTriangle {
+    glm::vec3 v0, v1, v2;
+    glm::vec3 normal;
+};
+
+// Raw byte streams for the collision cache. Only trivially copyable data,
+// arrays are stored as a 64-bit element count followed by the elements.
+struct TerrainBlobWriter {
+    std::vector<char> bytes;
+
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Cache data must be trivially copyable");
+        const char* data = reinterpret_cast<const char*>(&value);
+        bytes.insert(bytes.end(), data, data + sizeof(T));
+    }
+    template <typename T>
+    void WriteArray(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "Cache data must be trivially copyable");
+        Write(static_cast<uint64_t>(values.size()));
+        const char* data = reinterpret_cast<const char*>(values.data());
+        bytes.insert(bytes.end(), data, data + values.size() * sizeof(T));
+    }
+};
+
+struct TerrainBlobReader {
+    const char* cursor;
+    const char* end;
+
+    template <typename T>
+    bool Read(T& value) {
+        if (static_cast<size_t>(end - cursor) < sizeof(T)) return false;
+        std::memcpy(&value, cursor, sizeof(T));
+        cursor += sizeof(T);
+        return true;
+    }
+    template <typename T>
+    bool ReadArray(std::vector<T>& values) {
+        uint64_t count = 0;
+        if (!Read(count) || count > static_cast<size_t>(end - cursor) / sizeof(T)) return false;
+        values.resize(static_cast<size_t>(count));
+        if (!values.empty()) std::memcpy(values.data(), cursor, values.size() * sizeof(T));
+        cursor += values.size() * sizeof(T);
+        return true;
+    }
+};
+
+// Uniform XZ grid over the terrain bounds in compressed-sparse-row form.
+// Cell c owns m_triangleIndices[m_cellStart[c] .. m_cellStart[c + 1]).
+class SpatialGrid {
+public:
+    // Count, prefix sum, scatter; both passes split the triangles across the pool when given one
+    void Build(const std::vector<TerrainTriangle>& triangles, float cellSize, ThreadPool* pool = nullptr);
+    void Clear();
+    void Serialize(TerrainBlobWriter& out) const;
+    bool Deserialize(TerrainBlobReader& in);
+    // True when every index a query can reach is in range, for data loaded from disk
+    bool Validate(size_t triangleCount) const;
+
+    // Indices of every triangle whose XZ bounds overlap the cell containing (x, z)
+    const uint32_t* GetTrianglesAt(float x, float z, uint32_t& count) const {
+        count = 0;
+        if (m_cellStart.empty()) return nullptr;
+        int cellX = static_cast<int>(std::floor((x - m_origin.x) * m_invCellSize));
+        int cellZ = static_cast<int>(std::floor((z - m_origin.y) * m_invCellSize));
+        if (cellX < 0 || cellX >= m_cellsX || cellZ < 0 || cellZ >= m_cellsZ) return nullptr;
+
+        size_t cell = static_cast<size_t>(cellZ) * m_cellsX + cellX;
+        count = m_cellStart[cell + 1] - m_cellStart[cell];
+        return m_triangleIndices.data() + m_cellStart[cell];
+    }
+
+    template <typename Visitor>
+    void ForEachTriangleAt(float x, float z, Visitor&& visit) const {
+        uint32_t count;
+        const uint32_t* indices = GetTrianglesAt(x, z, count);
+        for (uint32_t i = 0; i < count; i++) {
+            visit(indices[i]);
+        }
+    }
+
+    bool IsEmpty() const { return m_cellStart.empty(); }
+    float GetCellSize() const { return m_cellSize; }
+    size_t GetCellCount() const { return static_cast<size_t>(m_cellsX) * m_cellsZ; }
+    size_t GetReferenceCount() const { return m_triangleIndices.size(); }
+    size_t GetMemoryUsage() const {
+        return (m_cellStart.size() + m_triangleIndices.size()) * sizeof(uint32_t);
+    }
+
+private:
+    glm::vec2 m_origin{0.0f};
+    float m_cellSize = 1.0f;
+    float m_invCellSize = 1.0f;
+    int m_cellsX = 0;
+    int m_cellsZ = 0;
+    std::vector<uint32_t> m_cellStart;
+    std::vector<uint32_t> m_triangleIndices;
+
+    void GetCellRange(const TerrainTriangle& tri, int& startX, int& endX, int& startZ, int& endZ) const;
+};
+
+struct TerrainHit {
+    glm::vec3 point{0.0f};                  // Contact point on the terrain
+    glm::vec3 normal{0.0f, 1.0f, 0.0f};     // Surface normal facing the caster
+    float distance = 0.0f;                  // Distance travelled before contact
+    float time = 1.0f;                      // Time of impact as a fraction of the cast [0, 1]
+    uint32_t triangle = 0;
+    glm::vec3 upNormal{0.0f, 1.0f, 0.0f};   // Face normal of the hit triangle turned to point up
+};
+
+// Everything a collision response needs about the terrain under one XZ point
+struct TerrainSample {
+    static constexpr uint32_t NO_TRIANGLE = 0xFFFFFFFFu;
+
+    float height;                           // Heightfield::NO_TERRAIN when off the map
+    glm::vec3 normal{0.0f, 1.0f, 0.0f};
+    uint32_t triangle = NO_TRIANGLE;
+};
+
+glm::vec3 ClosestPointOnTriangle(const glm::vec3& p, const TerrainTriangle& tri);
+
+// Bounding volume hierarchy over the terrain triangles for arbitrary
+// segment queries. Sibling nodes are stored next to each other, leaves
+// reference a contiguous range of m_triangleOrder.
+class TerrainBVH {
+public:
+    void Build(const std::vector<TerrainTriangle>& triangles);
+    void Clear();
+    void Serialize(TerrainBlobWriter& out) const;
+    bool Deserialize(TerrainBlobReader& in);
+    // True when the nodes form a tree shallow enough for the traversal stack and
+    // every leaf range and triangle index is in range
+    bool Validate(size_t triangleCount) const;
+
+    bool Raycast(const std::vector<TerrainTriangle>& triangles, const glm::vec3& origin,
+        const glm::vec3& dir, float maxDist, TerrainHit& hit) const;
+    bool SweepSphere(const std::vector<TerrainTriangle>& triangles, const glm::vec3& from,
+        const glm::vec3& to, float radius, TerrainHit& hit) const;
+    // Nearest surface point within maxDist of p
+    bool FindClosest(const std::vector<TerrainTriangle>& triangles, const glm::vec3& p, float maxDist,
+        glm::vec3& closest, uint32_t& triangle) const;
+
+    bool IsEmpty() const { return m_nodes.empty(); }
+    size_t GetNodeCount() const { return m_nodes.size(); }
+    size_t GetMemoryUsage() const {
+        return m_nodes.size() * sizeof(Node) + m_triangleOrder.size() * sizeof(uint32_t);
+    }
+
+private:
+    struct Node {
+        glm::vec3 boundsMin;
+        uint32_t leftFirst;     // First child index, or first triangle for leaves
+        glm::vec3 boundsMax;
+        uint32_t count;         // Triangle count, 0 for interior nodes
+    };
+    static constexpr uint32_t MAX_LEAF_SIZE = 4;
+    static constexpr int STACK_SIZE = 64;
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_triangleOrder;
+
+    void Subdivide(uint32_t nodeIndex, const std::vector<glm::vec3>& centroids,
+        const std::vector<TerrainTriangle>& triangles);
+};
+
+// Dense regular grid of terrain heights, sampled once at load time
+class Heightfield {
+public:
+    static constexpr float NO_TERRAIN = -1000.0f;
+
+    // sampleTerrain supplies the height and the triangle under each sample,
+    // it is called from the pool's threads when one is given
+    void Build(const glm::vec2& minBounds, const glm::vec2& maxBounds, float resolution,
+        const std::function<TerrainSample(float, float)>& sampleTerrain, ThreadPool* pool = nullptr);
+    void Clear();
+    void Serialize(TerrainBlobWriter& out) const;
+    bool Deserialize(TerrainBlobReader& in);
+    // True when every baked triangle id is in range or NO_TRIANGLE
+    bool Validate(size_t triangleCount) const;
+
+    // O(1) bilinear lookup, NO_TERRAIN outside the baked area
+    float GetHeight(float x, float z) const;
+    // Batched lookup, out[i] = GetHeight(xz[i].x, xz[i].y)
+    void GetHeights(const glm::vec2* xz, float* out, size_t count) const;
+    // Bilinear height plus the triangle baked at the nearest sample
+    float GetHeightAndTriangle(float x, float z, uint32_t& triangle) const;
+    // Just the triangle GetHeightAndTriangle picks
+    uint32_t GetTriangle(float x, float z) const;
+    // GetHeight, but NO_TERRAIN when the blend would mix in an unbaked sample
+    float GetCoveredHeight(float x, float z) const;
+
+    bool IsEmpty() const { return m_heights.empty(); }
+    int GetWidth() const { return m_width; }
+    int GetDepth() const { return m_depth; }
+    float GetSpacing() const { return m_spacing; }
+    const glm::vec2& GetMinBounds() const { return m_minBounds; }
+    const glm::vec2& GetMaxBounds() const { return m_maxBounds; }
+    size_t GetMemoryUsage() const {
+        return m_heights.size() * sizeof(float) + m_triangleIds.size() * sizeof(uint32_t);
+    }
+
+private:
+    glm::vec2 m_minBounds{0.0f};
+    glm::vec2 m_maxBounds{0.0f};
+    float m_spacing = 1.0f;
+    float m_invSpacing = 1.0f;
+    int m_width = 0;
+    int m_depth = 0;
+    std::vector<float> m_heights;
+    std::vector<uint32_t> m_triangleIds;
+};
+
+// Conservative min/max terrain height per square XZ cell. Each level halves
+// the resolution of the one below it, the last level is a single cell.
+class HeightPyramid {
+public:
+    void Build(const std::vector<TerrainTriangle>& triangles, float cellSize);
+    void Clear();
+    void Serialize(TerrainBlobWriter& out) const;
+    bool Deserialize(TerrainBlobReader& in);
+
+    // True when all terrain under the XZ rectangle is provably below y
+    bool IsAbove(const glm::vec2& minXZ, const glm::vec2& maxXZ, float y) const;
+    bool IsAbove(const glm::vec3& from, const glm::vec3& to, float radius) const {
+        return IsAbove(glm::vec2(std::min(from.x, to.x), std::min(from.z, to.z)) - radius,
+                       glm::vec2(std::max(from.x, to.x), std::max(from.z, to.z)) + radius,
+                       std::min(from.y, to.y) - radius);
+    }
+
+    bool IsEmpty() const { return m_levels.empty(); }
+    size_t GetLevelCount() const { return m_levels.size(); }
+    size_t GetMemoryUsage() const {
+        return m_levels.size() * sizeof(Level) + m_cellBounds.size() * sizeof(glm::vec2);
+    }
+
+private:
+    struct Level {
+        int width;
+        int depth;
+        uint32_t offset;        // First cell in m_cellBounds
+    };
+
+    glm::vec2 m_origin{0.0f};
+    float m_cellSize = 1.0f;
+    float m_invCellSize = 1.0f;
+    std::vector<Level> m_levels;
+    std::vector<glm::vec2> m_cellBounds;   // (min, max) height, empty cells are (FLT_MAX, -FLT_MAX)
+};
+
+// Signed distance to the terrain surface on a regular 3D lattice around the
+// mesh, positive above the surface and clamped to +-band.
+class TerrainDistanceField {
+public:
+    void Build(const std::vector<TerrainTriangle>& triangles, const TerrainBVH& bvh, float spacing, float band,
+        ThreadPool* pool = nullptr);
+    void Clear();
+    void Serialize(TerrainBlobWriter& out) const;
+    bool Deserialize(TerrainBlobReader& in);
+
+    // Conservative lower bound on the unsigned distance from p to the surface
+    float GetDistanceBound(const glm::vec3& p) const;
+
+    bool IsEmpty() const { return m_distances.empty(); }
+    glm::ivec3 GetSize() const { return glm::ivec3(m_sizeX, m_sizeY, m_sizeZ); }
+    size_t GetMemoryUsage() const { return m_distances.size() * sizeof(float); }
+
+private:
+    glm::vec3 m_origin{0.0f};
+    glm::vec3 m_terrainMin{0.0f};
+    glm::vec3 m_terrainMax{0.0f};
+    float m_spacing = 1.0f;
+    float m_invSpacing = 1.0f;
+    float m_halfDiagonal = 0.0f;    // Furthest any point is from its nearest lattice node
+    int m_sizeX = 0;
+    int m_sizeY = 0;
+    int m_sizeZ = 0;
+    std::vector<float> m_distances;
+};
+
+// Immutable terrain collision data. Built once per map load and only read
+// afterwards, so any number of threads can query the same snapshot.
+class TerrainCollision {
+public:
+    std::vector<TerrainTriangle> triangles;
+    SpatialGrid grid;
+    Heightfield heightfield;
+    TerrainBVH bvh;
+    HeightPyramid pyramid;
+    TerrainDistanceField distanceField;
+
+    void Serialize(TerrainBlobWriter& out) const;
+    bool Deserialize(TerrainBlobReader& in);
+
+    float GetHeightFromGrid(float x, float z) const;
+    float GetHeightFromMap(float x, float z) const { return heightfield.GetHeight(x, z); }
+    void GetHeightsFromGrid(const glm::vec2* xz, float* out, size_t count) const;
+    void GetHeightsFromMap(const glm::vec2* xz, float* out, size_t count) const { heightfield.GetHeights(xz, out, count); }
+    // Each normal comes from the same triangle the matching Sample call picks
+    glm::vec3 GetNormalFromGrid(float x, float z) const;
+    glm::vec3 GetNormalFromMap(float x, float z) const;
+
+    // Height, normal and triangle from a single pass over the grid cell
+    TerrainSample SampleFromGrid(float x, float z) const;
+    // Heightfield height, normal from the baked triangle id
+    TerrainSample SampleFromMap(float x, float z) const;
+
+    // dir must be normalized; hits further than maxDist are ignored
+    bool Raycast(const glm::vec3& origin, const glm::vec3& dir, float maxDist, TerrainHit& hit) const {
+        if (pyramid.IsAbove(origin, origin + dir * maxDist, 0.0f)) return false;
+        return bvh.Raycast(triangles, origin, dir, maxDist, hit);
+    }
+    // Sphere traces through the distance field, then resolves the exact contact with the BVH
+    bool SweepSphere(const glm::vec3& from, const glm::vec3& to, float radius, TerrainHit& hit) const;
+
+    size_t GetMemoryUsage() const {
+        return triangles.size() * sizeof(TerrainTriangle) + grid.GetMemoryUsage() + heightfield.GetMemoryUsage() +
+               bvh.GetMemoryUsage() + pyramid.GetMemoryUsage() + distanceField.GetMemoryUsage();
+    }
+};
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "TerrainCache.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char CACHE_MAGIC[4] = {'S', 'N', 'T', 'C'};
+// Bump whenever the layout of any serialized structure changes
+static const uint32_t CACHE_VERSION = 5;
+
+struct CacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceHash;
+    float cellSize;
+    float heightfieldResolution;
+    float collisionTolerance;
+    uint32_t reserved;
+    uint64_t payloadSize;
+};
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_mapping = mapping;
+    m_data = static_cast<const char*>(view);
+    m_size = static_cast<size_t>(size.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) return false;
+
+    m_data = static_cast<const char*>(view);
+    m_size = static_cast<size_t>(info.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::Close() {
+    if (!m_data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+    CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    munmap(const_cast<char*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+uint64_t HashFileContents(const std::string& path) {
+    MappedFile file;
+    if (!file.Open(path)) return 0;
+
+    // 64-bit FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(file.GetData());
+    for (size_t i = 0; i < file.GetSize(); i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool SaveTerrainCache(const std::string& path, const TerrainCacheKey& key, const TerrainCollision& terrain,
+    const Heightfield* renderHeightfield) {
+    TerrainBlobWriter payload;
+    terrain.Serialize(payload);
+    (renderHeightfield ? *renderHeightfield : Heightfield()).Serialize(payload);
+
+    CacheHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.sourceHash = key.sourceHash;
+    header.cellSize = key.cellSize;
+    header.heightfieldResolution = key.heightfieldResolution;
+    header.collisionTolerance = key.collisionTolerance;
+    header.reserved = 0;
+    header.payloadSize = payload.bytes.size();
+
+    // Write beside the cache and swap it in, so a crash mid-write never leaves a torn file behind
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (file) {
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(payload.bytes.data(), static_cast<std::streamsize>(payload.bytes.size()));
+            file.close();
+        }
+        if (!file) {
+            std::cerr << "Failed to write terrain cache: " << tempPath << std::endl;
+            std::error_code ignored;
+            std::filesystem::remove(tempPath, ignored);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        std::cerr << "Failed to replace terrain cache: " << path << " (" << error.message() << ")" << std::endl;
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
+
+bool LoadTerrainCache(const std::string& path, const TerrainCacheKey& key, TerrainCollision& terrain,
+    Heightfield* renderHeightfield) {
+    MappedFile file;
+    if (!file.Open(path) || file.GetSize() < sizeof(CacheHeader)) return false;
+
+    CacheHeader header;
+    std::memcpy(&header, file.GetData(), sizeof(header));
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header.version != CACHE_VERSION ||
+        header.sourceHash != key.sourceHash ||
+        header.cellSize != key.cellSize ||
+        header.heightfieldResolution != key.heightfieldResolution ||
+        header.collisionTolerance != key.collisionTolerance ||
+        header.payloadSize != file.GetSize() - sizeof(CacheHeader)) {
+        return false;
+    }
+
+    // Arrays are copied straight out of the mapping, nothing is parsed or rebuilt
+    TerrainBlobReader reader{file.GetData() + sizeof(CacheHeader), file.GetData() + file.GetSize()};
+    Heightfield ignoredHeightfield;
+    if (!terrain.Deserialize(reader) ||
+        !(renderHeightfield ? *renderHeightfield : ignoredHeightfield).Deserialize(reader) ||
+        reader.cursor != reader.end) {
+        if (renderHeightfield) renderHeightfield->Clear();
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
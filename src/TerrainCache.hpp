@@ -0,0 +1,44 @@
+#pragma once
+#include "Terrain.hpp"
+#include <string>
+#include <cstdint>
+
+// Read-only view of a whole file, memory-mapped where the OS allows it
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    const char* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+
+private:
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
+
+// Baked collision data is keyed by the source mesh and the bake settings,
+// any mismatch makes LoadTerrainCache fail and the caller rebuilds.
+struct TerrainCacheKey {
+    uint64_t sourceHash = 0;
+    float cellSize = 0.0f;
+    float heightfieldResolution = 0.0f;
+    float collisionTolerance = 0.0f;
+};
+
+uint64_t HashFileContents(const std::string& path);
+// renderHeightfield rides along for maps that draw from finer heights than they collide with,
+// it is stored empty when null and loads empty when the saving run had none
+bool SaveTerrainCache(const std::string& path, const TerrainCacheKey& key, const TerrainCollision& terrain,
+    const Heightfield* renderHeightfield = nullptr);
+bool LoadTerrainCache(const std::string& path, const TerrainCacheKey& key, TerrainCollision& terrain,
+    Heightfield* renderHeightfield = nullptr);
\ No newline at end of file
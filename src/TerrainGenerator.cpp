@@ -0,0 +1,366 @@
+#include "TerrainGenerator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define TERRAIN_SIMD_SSE2
+#include <immintrin.h>
+#endif
+
+static constexpr int MAX_OCTAVES = 16;
+static constexpr int ROW_GRAIN = 16;                        // Rows per pool block
+static constexpr float HASH_TO_UNIT = 2.0f / 16777215.0f;   // Top 24 hash bits to [0, 2]
+
+// Lattice hash constants, odd multipliers with good avalanche
+static constexpr uint32_t HASH_X = 0x27d4eb2du;
+static constexpr uint32_t HASH_Z = 0x165667b1u;
+static constexpr uint32_t HASH_MIX1 = 0x2c1b3c6du;
+static constexpr uint32_t HASH_MIX2 = 0x297a2d39u;
+
+struct Octave {
+    float frequency;
+    float amplitude;
+    uint32_t seed;
+};
+
+// Final height is sum(amplitude * noise) * scale + offset
+struct FractalSetup {
+    Octave octaves[MAX_OCTAVES];
+    int octaveCount;
+    float scale;
+    float offset;
+    float minCoord;
+    float spacing;
+};
+
+static FractalSetup PrepareFractal(const TerrainGeneratorSettings& settings) {
+    FractalSetup setup;
+    setup.octaveCount = std::clamp(settings.octaves, 1, MAX_OCTAVES);
+    float frequency = settings.frequency;
+    float amplitude = 1.0f;
+    float amplitudeSum = 0.0f;
+    for (int o = 0; o < setup.octaveCount; o++) {
+        // Every octave gets its own lattice so features don't line up across scales
+        setup.octaves[o] = {frequency, amplitude, settings.seed + static_cast<uint32_t>(o) * 0x9e3779b9u};
+        amplitudeSum += amplitude;
+        frequency *= settings.lacunarity;
+        amplitude *= settings.gain;
+    }
+    setup.scale = 0.5f * settings.heightScale / amplitudeSum;
+    setup.offset = 0.5f * settings.heightScale;
+    setup.minCoord = -0.5f * settings.size;
+    setup.spacing = settings.size / static_cast<float>(std::max(settings.resolution - 1, 1));
+    return setup;
+}
+
+static uint32_t HashLattice(int32_t x, int32_t z, uint32_t seed) {
+    uint32_t h = (static_cast<uint32_t>(x) * HASH_X) ^ (static_cast<uint32_t>(z) * HASH_Z) ^ seed;
+    h ^= h >> 15;
+    h *= HASH_MIX1;
+    h ^= h >> 12;
+    h *= HASH_MIX2;
+    h ^= h >> 15;
+    return h;
+}
+
+static float LatticeValue(int32_t x, int32_t z, uint32_t seed) {
+    return static_cast<float>(HashLattice(x, z, seed) >> 8) * HASH_TO_UNIT - 1.0f;
+}
+
+static float Fade(float t) {
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+// Value noise in [-1, 1] with quintic interpolation between lattice points
+static float ValueNoise(float x, float z, uint32_t seed) {
+    const float xf = std::floor(x);
+    const float zf = std::floor(z);
+    const int32_t xi = static_cast<int32_t>(xf);
+    const int32_t zi = static_cast<int32_t>(zf);
+    const float u = Fade(x - xf);
+    const float v = Fade(z - zf);
+
+    const float v00 = LatticeValue(xi, zi, seed);
+    const float v10 = LatticeValue(xi + 1, zi, seed);
+    const float v01 = LatticeValue(xi, zi + 1, seed);
+    const float v11 = LatticeValue(xi + 1, zi + 1, seed);
+    const float a = v00 + (v10 - v00) * u;
+    const float b = v01 + (v11 - v01) * u;
+    return a + (b - a) * v;
+}
+
+static float FractalHeight(const FractalSetup& setup, float x, float z) {
+    float sum = 0.0f;
+    for (int o = 0; o < setup.octaveCount; o++) {
+        const Octave& octave = setup.octaves[o];
+        sum += octave.amplitude * ValueNoise(x * octave.frequency, z * octave.frequency, octave.seed);
+    }
+    return sum * setup.scale + setup.offset;
+}
+
+static void FractalRowScalar(const FractalSetup& setup, float z, int count, float* out) {
+    for (int i = 0; i < count; i++) {
+        out[i] = FractalHeight(setup, setup.minCoord + static_cast<float>(i) * setup.spacing, z);
+    }
+}
+
+#if defined(__AVX2__)
+// 8 samples per iteration, same operation order as the scalar path
+static __m256 ValueNoise8(__m256 x, __m256 z, __m256i seed) {
+    const __m256 xf = _mm256_floor_ps(x);
+    const __m256 zf = _mm256_floor_ps(z);
+    const __m256i xi = _mm256_cvttps_epi32(xf);
+    const __m256i zi = _mm256_cvttps_epi32(zf);
+
+    auto fade = [](__m256 t) {
+        __m256 inner = _mm256_add_ps(_mm256_mul_ps(t, _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.0f)),
+            _mm256_set1_ps(15.0f))), _mm256_set1_ps(10.0f));
+        return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), inner);
+    };
+    auto lattice = [seed](__m256i hx, __m256i hz) {
+        __m256i h = _mm256_xor_si256(_mm256_xor_si256(hx, hz), seed);
+        h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+        h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(HASH_MIX1)));
+        h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 12));
+        h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(HASH_MIX2)));
+        h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+        return _mm256_sub_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(h, 8)),
+            _mm256_set1_ps(HASH_TO_UNIT)), _mm256_set1_ps(1.0f));
+    };
+
+    const __m256 u = fade(_mm256_sub_ps(x, xf));
+    const __m256 v = fade(_mm256_sub_ps(z, zf));
+    const __m256i hashX = _mm256_set1_epi32(static_cast<int>(HASH_X));
+    const __m256i hashZ = _mm256_set1_epi32(static_cast<int>(HASH_Z));
+    const __m256i x0 = _mm256_mullo_epi32(xi, hashX);
+    const __m256i x1 = _mm256_add_epi32(x0, hashX);
+    const __m256i z0 = _mm256_mullo_epi32(zi, hashZ);
+    const __m256i z1 = _mm256_add_epi32(z0, hashZ);
+
+    const __m256 v00 = lattice(x0, z0), v10 = lattice(x1, z0);
+    const __m256 v01 = lattice(x0, z1), v11 = lattice(x1, z1);
+    const __m256 a = _mm256_add_ps(v00, _mm256_mul_ps(_mm256_sub_ps(v10, v00), u));
+    const __m256 b = _mm256_add_ps(v01, _mm256_mul_ps(_mm256_sub_ps(v11, v01), u));
+    return _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), v));
+}
+
+static void FractalRowSimd(const FractalSetup& setup, float z, int count, float* out) {
+    const __m256 lane = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    for (int i = 0; i < count; i += 8) {
+        __m256 index = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), lane);
+        __m256 x = _mm256_add_ps(_mm256_set1_ps(setup.minCoord), _mm256_mul_ps(index, _mm256_set1_ps(setup.spacing)));
+        __m256 sum = _mm256_setzero_ps();
+        for (int o = 0; o < setup.octaveCount; o++) {
+            const Octave& octave = setup.octaves[o];
+            __m256 frequency = _mm256_set1_ps(octave.frequency);
+            __m256 noise = ValueNoise8(_mm256_mul_ps(x, frequency), _mm256_mul_ps(_mm256_set1_ps(z), frequency),
+                _mm256_set1_epi32(static_cast<int>(octave.seed)));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(octave.amplitude), noise));
+        }
+        __m256 height = _mm256_add_ps(_mm256_mul_ps(sum, _mm256_set1_ps(setup.scale)), _mm256_set1_ps(setup.offset));
+
+        // The last block of a row may be partial
+        if (i + 8 <= count) {
+            _mm256_storeu_ps(out + i, height);
+        } else {
+            alignas(32) float tail[8];
+            _mm256_store_ps(tail, height);
+            std::copy(tail, tail + (count - i), out + i);
+        }
+    }
+}
+#elif defined(TERRAIN_SIMD_SSE2)
+// SSE2 has no 32-bit low multiply, build it from two 32x32->64 multiplies
+static __m128i MulLo32(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// Truncation rounds toward zero, step back where that landed above x
+static __m128 Floor4(__m128 x, __m128i& xi) {
+    xi = _mm_cvttps_epi32(x);
+    __m128 truncated = _mm_cvtepi32_ps(xi);
+    __m128 above = _mm_cmpgt_ps(truncated, x);
+    xi = _mm_add_epi32(xi, _mm_castps_si128(above));
+    return _mm_sub_ps(truncated, _mm_and_ps(above, _mm_set1_ps(1.0f)));
+}
+
+// 4 samples per iteration, same operation order as the scalar path
+static __m128 ValueNoise4(__m128 x, __m128 z, __m128i seed) {
+    __m128i xi, zi;
+    const __m128 xf = Floor4(x, xi);
+    const __m128 zf = Floor4(z, zi);
+
+    auto fade = [](__m128 t) {
+        __m128 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)),
+            _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f));
+        return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner);
+    };
+    auto lattice = [seed](__m128i hx, __m128i hz) {
+        __m128i h = _mm_xor_si128(_mm_xor_si128(hx, hz), seed);
+        h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+        h = MulLo32(h, _mm_set1_epi32(static_cast<int>(HASH_MIX1)));
+        h = _mm_xor_si128(h, _mm_srli_epi32(h, 12));
+        h = MulLo32(h, _mm_set1_epi32(static_cast<int>(HASH_MIX2)));
+        h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+        return _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(h, 8)), _mm_set1_ps(HASH_TO_UNIT)),
+            _mm_set1_ps(1.0f));
+    };
+
+    const __m128 u = fade(_mm_sub_ps(x, xf));
+    const __m128 v = fade(_mm_sub_ps(z, zf));
+    const __m128i hashX = _mm_set1_epi32(static_cast<int>(HASH_X));
+    const __m128i hashZ = _mm_set1_epi32(static_cast<int>(HASH_Z));
+    // (x + 1) * K == x * K + K, so the neighbours need no extra multiplies
+    const __m128i x0 = MulLo32(xi, hashX);
+    const __m128i x1 = _mm_add_epi32(x0, hashX);
+    const __m128i z0 = MulLo32(zi, hashZ);
+    const __m128i z1 = _mm_add_epi32(z0, hashZ);
+
+    const __m128 v00 = lattice(x0, z0), v10 = lattice(x1, z0);
+    const __m128 v01 = lattice(x0, z1), v11 = lattice(x1, z1);
+    const __m128 a = _mm_add_ps(v00, _mm_mul_ps(_mm_sub_ps(v10, v00), u));
+    const __m128 b = _mm_add_ps(v01, _mm_mul_ps(_mm_sub_ps(v11, v01), u));
+    return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), v));
+}
+
+static void FractalRowSimd(const FractalSetup& setup, float z, int count, float* out) {
+    const __m128 lane = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    for (int i = 0; i < count; i += 4) {
+        __m128 index = _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), lane);
+        __m128 x = _mm_add_ps(_mm_set1_ps(setup.minCoord), _mm_mul_ps(index, _mm_set1_ps(setup.spacing)));
+        __m128 sum = _mm_setzero_ps();
+        for (int o = 0; o < setup.octaveCount; o++) {
+            const Octave& octave = setup.octaves[o];
+            __m128 frequency = _mm_set1_ps(octave.frequency);
+            __m128 noise = ValueNoise4(_mm_mul_ps(x, frequency), _mm_mul_ps(_mm_set1_ps(z), frequency),
+                _mm_set1_epi32(static_cast<int>(octave.seed)));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(octave.amplitude), noise));
+        }
+        __m128 height = _mm_add_ps(_mm_mul_ps(sum, _mm_set1_ps(setup.scale)), _mm_set1_ps(setup.offset));
+
+        // The last block of a row may be partial
+        if (i + 4 <= count) {
+            _mm_storeu_ps(out + i, height);
+        } else {
+            alignas(16) float tail[4];
+            _mm_store_ps(tail, height);
+            std::copy(tail, tail + (count - i), out + i);
+        }
+    }
+}
+#else
+static void FractalRowSimd(const FractalSetup& setup, float z, int count, float* out) {
+    FractalRowScalar(setup, z, count, out);
+}
+#endif
+
+static void GenerateRows(const FractalSetup& setup, int resolution, int rowBegin, int rowEnd, bool vectorized, float* heights) {
+    for (int row = rowBegin; row < rowEnd; row++) {
+        const float z = setup.minCoord + static_cast<float>(row) * setup.spacing;
+        float* out = heights + static_cast<size_t>(row) * resolution;
+        if (vectorized) {
+            FractalRowSimd(setup, z, resolution, out);
+        } else {
+            FractalRowScalar(setup, z, resolution, out);
+        }
+    }
+}
+
+// Splits [0, rows) into a few blocks per worker and waits for all of them.
+// Must be called from outside the pool.
+void TerrainGenerator::GenerateHeights(const TerrainGeneratorSettings& settings, ThreadPool& pool, std::vector<float>& heights) {
+    const int resolution = std::max(settings.resolution, 2);
+    const FractalSetup setup = PrepareFractal(settings);
+    heights.resize(static_cast<size_t>(resolution) * resolution);
+    pool.ParallelFor(resolution, ROW_GRAIN, [&](int begin, int end) {
+        GenerateRows(setup, resolution, begin, end, true, heights.data());
+    });
+}
+
+void TerrainGenerator::BuildMesh(const TerrainGeneratorSettings& settings, const std::vector<float>& heights, ThreadPool& pool,
+    std::vector<glm::vec3>& positions, std::vector<glm::vec3>& normals, std::vector<unsigned int>& indices) {
+    const int resolution = std::max(settings.resolution, 2);
+    const FractalSetup setup = PrepareFractal(settings);
+    const size_t vertexCount = static_cast<size_t>(resolution) * resolution;
+    if (heights.size() != vertexCount) return;
+
+    positions.resize(vertexCount);
+    normals.resize(vertexCount);
+    indices.resize(static_cast<size_t>(resolution - 1) * (resolution - 1) * 6);
+
+    pool.ParallelFor(resolution, ROW_GRAIN, [&](int begin, int end) {
+        auto height = [&](int x, int z) { return heights[static_cast<size_t>(z) * resolution + x]; };
+        for (int z = begin; z < end; z++) {
+            const int up = std::max(z - 1, 0), down = std::min(z + 1, resolution - 1);
+            for (int x = 0; x < resolution; x++) {
+                const size_t v = static_cast<size_t>(z) * resolution + x;
+                positions[v] = glm::vec3(setup.minCoord + x * setup.spacing, height(x, z), setup.minCoord + z * setup.spacing);
+
+                // Central differences, one-sided on the border
+                const int left = std::max(x - 1, 0), right = std::min(x + 1, resolution - 1);
+                float slopeX = (height(right, z) - height(left, z)) / ((right - left) * setup.spacing);
+                float slopeZ = (height(x, down) - height(x, up)) / ((down - up) * setup.spacing);
+                normals[v] = glm::normalize(glm::vec3(-slopeX, 1.0f, -slopeZ));
+            }
+
+            // Same a-c-b / b-c-d split as the LOD tiles, counter-clockwise from above
+            if (z == resolution - 1) continue;
+            unsigned int* quad = &indices[static_cast<size_t>(z) * (resolution - 1) * 6];
+            for (int x = 0; x < resolution - 1; x++) {
+                unsigned int a = static_cast<unsigned int>(z * resolution + x);
+                unsigned int b = a + 1;
+                unsigned int c = a + resolution;
+                unsigned int d = c + 1;
+                *quad++ = a; *quad++ = c; *quad++ = b;
+                *quad++ = b; *quad++ = c; *quad++ = d;
+            }
+        }
+    });
+}
+
+float TerrainGenerator::SampleHeight(const TerrainGeneratorSettings& settings, float x, float z) {
+    return FractalHeight(PrepareFractal(settings), x, z);
+}
+
+void TerrainGenerator::Benchmark(const TerrainGeneratorSettings& settings, ThreadPool& pool, const std::vector<int>& resolutions) {
+    using Clock = std::chrono::high_resolution_clock;
+    for (int resolution : resolutions) {
+        TerrainGeneratorSettings sized = settings;
+        sized.resolution = resolution;
+        const FractalSetup setup = PrepareFractal(sized);
+        const size_t sampleCount = static_cast<size_t>(resolution) * resolution;
+        std::vector<float> scalar(sampleCount), simd(sampleCount), parallel;
+
+        // The scalar reference only runs a band of rows, scaled up to the full grid
+        const int scalarRows = std::min(resolution, 256);
+        auto scalarStart = Clock::now();
+        GenerateRows(setup, resolution, 0, scalarRows, false, scalar.data());
+        auto simdStart = Clock::now();
+        GenerateRows(setup, resolution, 0, resolution, true, simd.data());
+        auto parallelStart = Clock::now();
+        GenerateHeights(sized, pool, parallel);
+        auto parallelEnd = Clock::now();
+
+        float maxDifference = 0.0f;
+        for (size_t i = 0; i < sampleCount; i++) {
+            if (i < static_cast<size_t>(scalarRows) * resolution) {
+                maxDifference = std::max(maxDifference, std::abs(scalar[i] - simd[i]));
+            }
+            maxDifference = std::max(maxDifference, std::abs(simd[i] - parallel[i]));
+        }
+
+        float scalarMs = std::chrono::duration<float, std::milli>(simdStart - scalarStart).count() * resolution / scalarRows;
+        float parallelMs = std::chrono::duration<float, std::milli>(parallelEnd - parallelStart).count();
+        std::cout << "Terrain generator " << resolution << "x" << resolution << ": scalar "
+                  << scalarMs << " ms, SIMD "
+                  << std::chrono::duration<float, std::milli>(parallelStart - simdStart).count() << " ms, SIMD on "
+                  << pool.GetThreadCount() << " threads " << parallelMs << " ms ("
+                  << sampleCount / std::max(parallelMs, 0.001f) / 1000.0f << " M samples/s), max difference "
+                  << maxDifference << std::endl;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "ThreadPool.hpp"
+
+struct TerrainGeneratorSettings {
+    uint32_t seed = 1;
+    int resolution = 256;           // Samples along each edge
+    float size = 200.0f;            // World units along each edge, centered on the origin
+    float heightScale = 30.0f;      // Heights span [0, heightScale]
+    float frequency = 0.015f;       // Cycles per world unit of the first octave
+    int octaves = 6;
+    float lacunarity = 2.0f;        // Frequency multiplier per octave
+    float gain = 0.5f;              // Amplitude multiplier per octave
+};
+
+// Fractal value noise terrain. The same seed and settings always produce the
+// same heights, independent of the thread count.
+class TerrainGenerator {
+public:
+    // Row-major resolution x resolution heights, rows split across the pool
+    static void GenerateHeights(const TerrainGeneratorSettings& settings, ThreadPool& pool, std::vector<float>& heights);
+
+    // Grid mesh over the heights with central-difference normals, wound to face up
+    static void BuildMesh(const TerrainGeneratorSettings& settings, const std::vector<float>& heights, ThreadPool& pool,
+        std::vector<glm::vec3>& positions, std::vector<glm::vec3>& normals, std::vector<unsigned int>& indices);
+
+    // Scalar reference for a single point
+    static float SampleHeight(const TerrainGeneratorSettings& settings, float x, float z);
+
+    // Times the scalar and vectorized kernels on one thread and on the pool
+    static void Benchmark(const TerrainGeneratorSettings& settings, ThreadPool& pool, const std::vector<int>& resolutions);
+};
\ No newline at end of file
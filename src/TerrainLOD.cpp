@@ -0,0 +1,224 @@
+#include "TerrainLOD.hpp"
+#include "Camera.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// Grid vertices come first, then one skirt vertex under each edge vertex
+static constexpr int TILE_VERTS = TerrainLOD::TILE_QUADS + 1;
+static constexpr int GRID_VERTEX_COUNT = TILE_VERTS * TILE_VERTS;
+static constexpr int TILE_VERTEX_COUNT = GRID_VERTEX_COUNT + 4 * TILE_VERTS;
+
+// Skirt vertex index for edge vertex i of edge 0..3 (north, south, west, east)
+static unsigned int SkirtVertex(int edge, int i) {
+    return GRID_VERTEX_COUNT + edge * TILE_VERTS + i;
+}
+
+static void AppendLevelIndices(int step, std::vector<unsigned int>& indices) {
+    auto gridVertex = [](int x, int z) { return static_cast<unsigned int>(z * TILE_VERTS + x); };
+
+    for (int z = 0; z < TerrainLOD::TILE_QUADS; z += step) {
+        for (int x = 0; x < TerrainLOD::TILE_QUADS; x += step) {
+            unsigned int a = gridVertex(x, z);
+            unsigned int b = gridVertex(x + step, z);
+            unsigned int c = gridVertex(x, z + step);
+            unsigned int d = gridVertex(x + step, z + step);
+            indices.insert(indices.end(), {a, c, b, b, c, d});
+        }
+    }
+
+    // Skirts hang from the edge vertices this level actually uses
+    for (int i = 0; i < TerrainLOD::TILE_QUADS; i += step) {
+        const unsigned int edges[4][2] = {
+            {gridVertex(i, 0), gridVertex(i + step, 0)},
+            {gridVertex(i, TerrainLOD::TILE_QUADS), gridVertex(i + step, TerrainLOD::TILE_QUADS)},
+            {gridVertex(0, i), gridVertex(0, i + step)},
+            {gridVertex(TerrainLOD::TILE_QUADS, i), gridVertex(TerrainLOD::TILE_QUADS, i + step)},
+        };
+        for (int edge = 0; edge < 4; edge++) {
+            unsigned int top0 = edges[edge][0], top1 = edges[edge][1];
+            unsigned int bottom0 = SkirtVertex(edge, i), bottom1 = SkirtVertex(edge, i + step);
+            indices.insert(indices.end(), {top0, bottom0, top1, top1, bottom0, bottom1});
+        }
+    }
+}
+
+bool TerrainLOD::Build(const Heightfield& heightfield, float vertexSpacing) {
+    Release();
+    if (heightfield.IsEmpty() || vertexSpacing <= 0.0f) return false;
+
+    const glm::vec2 minBounds = heightfield.GetMinBounds();
+    const glm::vec2 maxBounds = heightfield.GetMaxBounds();
+    const int quadsX = static_cast<int>(std::ceil((maxBounds.x - minBounds.x) / vertexSpacing));
+    const int quadsZ = static_cast<int>(std::ceil((maxBounds.y - minBounds.y) / vertexSpacing));
+    const int tilesX = (quadsX + TILE_QUADS - 1) / TILE_QUADS;
+    const int tilesZ = (quadsZ + TILE_QUADS - 1) / TILE_QUADS;
+    const float skirtDepth = 4.0f * vertexSpacing;
+
+    // Clamp to the baked area so the last row of tiles folds onto the map edge.
+    // Uncovered vertices keep NO_TERRAIN and the terrain shader drops their triangles
+    auto heightAt = [&](float x, float z) {
+        return heightfield.GetCoveredHeight(std::clamp(x, minBounds.x, maxBounds.x), std::clamp(z, minBounds.y, maxBounds.y));
+    };
+    // Hole neighbours fall back to the centre height so edge normals stay level
+    auto neighbourAt = [&](float x, float z, float centre) {
+        float h = heightAt(x, z);
+        return h == Heightfield::NO_TERRAIN ? centre : h;
+    };
+    auto worldX = [&](int quad) { return std::min(minBounds.x + quad * vertexSpacing, maxBounds.x); };
+    auto worldZ = [&](int quad) { return std::min(minBounds.y + quad * vertexSpacing, maxBounds.y); };
+
+    // Interleaved position, color, normal
+    std::vector<float> vertexData;
+    vertexData.reserve(static_cast<size_t>(tilesX) * tilesZ * TILE_VERTEX_COUNT * 9);
+    auto pushVertex = [&](const glm::vec3& p, const glm::vec3& n) {
+        vertexData.insert(vertexData.end(), {p.x, p.y, p.z, 0.7f, 0.7f, 0.7f, n.x, n.y, n.z});
+    };
+
+    std::vector<glm::vec3> grid(GRID_VERTEX_COUNT);
+    std::vector<glm::vec3> normals(GRID_VERTEX_COUNT);
+    for (int tileZ = 0; tileZ < tilesZ; tileZ++) {
+        for (int tileX = 0; tileX < tilesX; tileX++) {
+            Tile tile;
+            tile.boundsMin = glm::vec3(FLT_MAX);
+            tile.boundsMax = glm::vec3(-FLT_MAX);
+            tile.baseVertex = static_cast<GLint>(m_tiles.size() * TILE_VERTEX_COUNT);
+
+            for (int z = 0; z < TILE_VERTS; z++) {
+                for (int x = 0; x < TILE_VERTS; x++) {
+                    float px = worldX(tileX * TILE_QUADS + x);
+                    float pz = worldZ(tileZ * TILE_QUADS + z);
+                    glm::vec3 p(px, heightAt(px, pz), pz);
+                    grid[z * TILE_VERTS + x] = p;
+                    normals[z * TILE_VERTS + x] = glm::normalize(glm::vec3(
+                        neighbourAt(px - vertexSpacing, pz, p.y) - neighbourAt(px + vertexSpacing, pz, p.y),
+                        2.0f * vertexSpacing,
+                        neighbourAt(px, pz - vertexSpacing, p.y) - neighbourAt(px, pz + vertexSpacing, p.y)));
+                    if (p.y == Heightfield::NO_TERRAIN) continue;
+                    tile.boundsMin = glm::min(tile.boundsMin, p);
+                    tile.boundsMax = glm::max(tile.boundsMax, p);
+                }
+            }
+            // Nothing in this tile would survive the shader
+            if (tile.boundsMin.y > tile.boundsMax.y) continue;
+            tile.boundsMin.y -= skirtDepth;
+
+            for (int i = 0; i < GRID_VERTEX_COUNT; i++) {
+                pushVertex(grid[i], normals[i]);
+            }
+            const int edgeStart[4][2] = {{0, 0}, {0, TILE_QUADS}, {0, 0}, {TILE_QUADS, 0}};
+            for (int edge = 0; edge < 4; edge++) {
+                for (int i = 0; i < TILE_VERTS; i++) {
+                    int x = edge < 2 ? i : edgeStart[edge][0];
+                    int z = edge < 2 ? edgeStart[edge][1] : i;
+                    pushVertex(grid[z * TILE_VERTS + x] - glm::vec3(0.0f, skirtDepth, 0.0f), normals[z * TILE_VERTS + x]);
+                }
+            }
+
+            // Geometric error: worst height difference between full detail and each coarser level
+            for (int level = 0; level < LEVEL_COUNT; level++) {
+                const int step = 1 << level;
+                float error = level > 0 ? tile.error[level - 1] : 0.0f;
+                for (int z = 0; z < TILE_VERTS; z++) {
+                    for (int x = 0; x < TILE_VERTS; x++) {
+                        int x0 = std::min(x / step * step, TILE_QUADS - step);
+                        int z0 = std::min(z / step * step, TILE_QUADS - step);
+                        float fx = static_cast<float>(x - x0) / step;
+                        float fz = static_cast<float>(z - z0) / step;
+                        float ha = grid[z0 * TILE_VERTS + x0].y;
+                        float hb = grid[z0 * TILE_VERTS + x0 + step].y;
+                        float hc = grid[(z0 + step) * TILE_VERTS + x0].y;
+                        float hd = grid[(z0 + step) * TILE_VERTS + x0 + step].y;
+                        float fine = grid[z * TILE_VERTS + x].y;
+                        // Holes are discarded at every level, they carry no error
+                        if (std::min({ha, hb, hc, hd, fine}) == Heightfield::NO_TERRAIN) continue;
+                        // Same b-c diagonal split as the index buffers
+                        float coarse = fx + fz <= 1.0f
+                            ? ha + (hb - ha) * fx + (hc - ha) * fz
+                            : hd + (hc - hd) * (1.0f - fx) + (hb - hd) * (1.0f - fz);
+                        error = std::max(error, std::abs(coarse - fine));
+                    }
+                }
+                tile.error[level] = error;
+            }
+            m_tiles.push_back(tile);
+        }
+    }
+
+    if (m_tiles.empty()) return false;
+
+    // One index list per level, shared by every tile through the base vertex
+    std::vector<unsigned int> indices;
+    for (int level = 0; level < LEVEL_COUNT; level++) {
+        size_t first = indices.size();
+        AppendLevelIndices(1 << level, indices);
+        m_levels[level].indexOffset = first * sizeof(unsigned int);
+        m_levels[level].indexCount = static_cast<GLsizei>(indices.size() - first);
+        const int quads = TILE_QUADS >> level;
+        m_levels[level].triangleCount = quads * quads * 2;
+    }
+
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_VBO);
+    glGenBuffers(1, &m_EBO);
+    glBindVertexArray(m_VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(float), vertexData.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+    const GLsizei stride = 9 * sizeof(float);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    glBindVertexArray(0);
+    return true;
+}
+
+void TerrainLOD::Release() {
+    if (m_VAO) glDeleteVertexArrays(1, &m_VAO);
+    if (m_VBO) glDeleteBuffers(1, &m_VBO);
+    if (m_EBO) glDeleteBuffers(1, &m_EBO);
+    m_VAO = m_VBO = m_EBO = 0;
+    m_tiles.clear();
+}
+
+void TerrainLOD::Draw(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& offset,
+    float maxPixelError, float viewportHeight, float renderDistance) {
+    m_stats = {};
+    if (m_tiles.empty()) return;
+
+    const Frustum frustum = Frustum::FromMatrix(projection * view);
+    const glm::vec3 eye = glm::vec3(glm::inverse(view)[3]);
+    // World units at distance 1 to pixels, projection[1][1] is cot(fovY / 2)
+    const float pixelsPerUnit = 0.5f * viewportHeight * projection[1][1];
+
+    glBindVertexArray(m_VAO);
+    for (const Tile& tile : m_tiles) {
+        glm::vec3 boundsMin = tile.boundsMin + offset;
+        glm::vec3 boundsMax = tile.boundsMax + offset;
+        float distance = glm::length(glm::clamp(eye, boundsMin, boundsMax) - eye);
+        if (distance > renderDistance || !frustum.IntersectsAABB(boundsMin, boundsMax)) {
+            m_stats.culledTiles++;
+            continue;
+        }
+
+        // Coarsest level whose error still projects under the threshold
+        int level = 0;
+        float scale = pixelsPerUnit / std::max(distance, 1.0f);
+        while (level + 1 < LEVEL_COUNT && tile.error[level + 1] * scale <= maxPixelError) {
+            level++;
+        }
+
+        glDrawElementsBaseVertex(GL_TRIANGLES, m_levels[level].indexCount, GL_UNSIGNED_INT,
+            reinterpret_cast<const void*>(m_levels[level].indexOffset), tile.baseVertex);
+        m_stats.tiles[level]++;
+        m_stats.triangles[level] += m_levels[level].triangleCount;
+    }
+    glBindVertexArray(0);
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "Terrain.hpp"
+
+// Geomipmapped terrain mesh built from the collision heightfield. The map is
+// split into square tiles that each pick a level of detail from their
+// projected geometric error, skirts hide the cracks between levels.
+class TerrainLOD {
+public:
+    static constexpr int TILE_QUADS = 32;       // Quads along a tile edge at full detail
+    static constexpr int LEVEL_COUNT = 6;       // 32, 16, 8, 4, 2 and 1 quads per edge
+
+    struct FrameStats {
+        unsigned int tiles[LEVEL_COUNT];
+        unsigned int triangles[LEVEL_COUNT];
+        unsigned int culledTiles;
+    };
+
+    TerrainLOD() = default;
+    ~TerrainLOD() { Release(); }
+    // Owns GL objects, a copy would delete them twice
+    TerrainLOD(const TerrainLOD&) = delete;
+    TerrainLOD& operator=(const TerrainLOD&) = delete;
+
+    // vertexSpacing is the distance between full-detail vertices in world units
+    bool Build(const Heightfield& heightfield, float vertexSpacing);
+    void Release();
+
+    // Expects the terrain shader to be bound with its model matrix set to offset
+    void Draw(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& offset,
+        float maxPixelError, float viewportHeight, float renderDistance);
+
+    bool IsEmpty() const { return m_tiles.empty(); }
+    const FrameStats& GetFrameStats() const { return m_stats; }
+
+private:
+    struct Tile {
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+        GLint baseVertex;
+        float error[LEVEL_COUNT];       // Max height deviation from full detail, non-decreasing
+    };
+    struct Level {
+        GLsizei indexCount;
+        size_t indexOffset;             // Bytes into the shared element buffer
+        unsigned int triangleCount;
+    };
+
+    GLuint m_VAO = 0, m_VBO = 0, m_EBO = 0;
+    std::vector<Tile> m_tiles;
+    Level m_levels[LEVEL_COUNT] = {};
+    FrameStats m_stats = {};
+};
\ No newline at end of file
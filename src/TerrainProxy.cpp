@@ -0,0 +1,336 @@
+#include "TerrainProxy.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+// A collapse may not turn any surviving face further than this from its old facing
+static constexpr float MIN_NORMAL_DOT = 0.5f;
+
+// Symmetric 4x4 error quadric, the sum of squared distances to a set of planes
+struct Quadric {
+    double a2 = 0, ab = 0, ac = 0, ad = 0;
+    double b2 = 0, bc = 0, bd = 0;
+    double c2 = 0, cd = 0;
+    double d2 = 0;
+
+    void AddPlane(const glm::dvec3& n, double d) {
+        a2 += n.x * n.x; ab += n.x * n.y; ac += n.x * n.z; ad += n.x * d;
+        b2 += n.y * n.y; bc += n.y * n.z; bd += n.y * d;
+        c2 += n.z * n.z; cd += n.z * d;
+        d2 += d * d;
+    }
+    Quadric& operator+=(const Quadric& q) {
+        a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+        b2 += q.b2; bc += q.bc; bd += q.bd;
+        c2 += q.c2; cd += q.cd;
+        d2 += q.d2;
+        return *this;
+    }
+    double Evaluate(const glm::dvec3& p) const {
+        return a2 * p.x * p.x + 2.0 * ab * p.x * p.y + 2.0 * ac * p.x * p.z + 2.0 * ad * p.x +
+               b2 * p.y * p.y + 2.0 * bc * p.y * p.z + 2.0 * bd * p.y +
+               c2 * p.z * p.z + 2.0 * cd * p.z + d2;
+    }
+    // Point with the least error, false when the planes don't pin one down
+    bool Minimize(glm::dvec3& p) const {
+        const double det = a2 * (b2 * c2 - bc * bc) - ab * (ab * c2 - bc * ac) + ac * (ab * bc - b2 * ac);
+        const double scale = a2 + b2 + c2;
+        if (std::abs(det) <= 1e-9 * scale * scale * scale) return false;
+        // Cramer's rule on [a2 ab ac; ab b2 bc; ac bc c2] p = -(ad, bd, cd)
+        const double inv = 1.0 / det;
+        p.x = -inv * (ad * (b2 * c2 - bc * bc) - ab * (bd * c2 - bc * cd) + ac * (bd * bc - b2 * cd));
+        p.y = -inv * (a2 * (bd * c2 - cd * bc) - ad * (ab * c2 - bc * ac) + ac * (ab * cd - bd * ac));
+        p.z = -inv * (a2 * (b2 * cd - bc * bd) - ab * (ab * cd - bd * ac) + ad * (ab * bc - b2 * ac));
+        return true;
+    }
+};
+
+struct CollapseCandidate {
+    float cost;
+    uint32_t a, b;
+    uint32_t stampA, stampB;
+    glm::vec3 target;
+
+    bool operator>(const CollapseCandidate& other) const { return cost > other.cost; }
+};
+
+struct PositionHash {
+    size_t operator()(const glm::vec3& p) const {
+        // Adding zero folds -0 into +0, they compare equal so they must hash equal
+        const glm::vec3 folded = p + glm::vec3(0.0f);
+        uint32_t bits[3];
+        std::memcpy(bits, &folded, sizeof(bits));
+        return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+    }
+};
+
+class EdgeCollapser {
+public:
+    EdgeCollapser(const std::vector<TerrainTriangle>& triangles) {
+        // Weld exact duplicates, render meshes split vertices along normal and UV seams
+        std::unordered_map<glm::vec3, uint32_t, PositionHash> welded;
+        welded.reserve(triangles.size());
+        auto weld = [&](const glm::vec3& p) {
+            auto inserted = welded.emplace(p, static_cast<uint32_t>(m_positions.size()));
+            if (inserted.second) m_positions.push_back(p);
+            return inserted.first->second;
+        };
+        m_faces.reserve(triangles.size());
+        for (const TerrainTriangle& tri : triangles) {
+            std::array<uint32_t, 3> face = {weld(tri.v0), weld(tri.v1), weld(tri.v2)};
+            if (face[0] == face[1] || face[1] == face[2] || face[0] == face[2]) continue;
+            m_faces.push_back(face);
+        }
+
+        const size_t vertexCount = m_positions.size();
+        m_quadrics.resize(vertexCount);
+        m_vertexFaces.resize(vertexCount);
+        m_stamps.assign(vertexCount, 0);
+        m_vertexAlive.assign(vertexCount, true);
+        m_faceAlive.assign(m_faces.size(), true);
+
+        // Every vertex starts with the planes of the faces around it
+        std::unordered_map<uint64_t, uint32_t> edgeUses;
+        edgeUses.reserve(m_faces.size() * 3);
+        for (uint32_t f = 0; f < m_faces.size(); f++) {
+            const auto& face = m_faces[f];
+            glm::dvec3 normal;
+            if (!GetFaceNormal(face, normal)) continue;
+            const double d = -glm::dot(normal, glm::dvec3(m_positions[face[0]]));
+            for (int i = 0; i < 3; i++) {
+                m_quadrics[face[i]].AddPlane(normal, d);
+                m_vertexFaces[face[i]].push_back(f);
+                edgeUses[EdgeKey(face[i], face[(i + 1) % 3])]++;
+            }
+        }
+
+        // Open and non-manifold edges get a perpendicular plane so they only slide along themselves
+        for (uint32_t f = 0; f < m_faces.size(); f++) {
+            const auto& face = m_faces[f];
+            glm::dvec3 normal;
+            if (!GetFaceNormal(face, normal)) continue;
+            for (int i = 0; i < 3; i++) {
+                const uint32_t v0 = face[i], v1 = face[(i + 1) % 3];
+                if (edgeUses[EdgeKey(v0, v1)] == 2) continue;
+                glm::dvec3 edge = glm::dvec3(m_positions[v1]) - glm::dvec3(m_positions[v0]);
+                glm::dvec3 side = glm::cross(edge, normal);
+                const double length = glm::length(side);
+                if (length <= 0.0) continue;
+                side /= length;
+                const double d = -glm::dot(side, glm::dvec3(m_positions[v0]));
+                m_quadrics[v0].AddPlane(side, d);
+                m_quadrics[v1].AddPlane(side, d);
+            }
+        }
+    }
+
+    size_t GetVertexCount() const { return m_positions.size(); }
+
+    // Collapses the cheapest edges first until the next one would exceed maxError
+    float Simplify(float maxError) {
+        const float maxCost = maxError * maxError;
+        for (uint32_t f = 0; f < m_faces.size(); f++) {
+            for (int i = 0; i < 3; i++) {
+                const uint32_t v0 = m_faces[f][i], v1 = m_faces[f][(i + 1) % 3];
+                // Interior edges appear in two faces, queue them once
+                if (v0 < v1 || !HasEdge(v1, v0)) PushCandidate(v0, v1);
+            }
+        }
+
+        float acceptedCost = 0.0f;
+        while (!m_queue.empty()) {
+            const CollapseCandidate candidate = m_queue.top();
+            m_queue.pop();
+            if (!m_vertexAlive[candidate.a] || !m_vertexAlive[candidate.b] ||
+                m_stamps[candidate.a] != candidate.stampA || m_stamps[candidate.b] != candidate.stampB) {
+                continue;
+            }
+            // Live candidates come out in cost order, everything left is worse
+            if (candidate.cost > maxCost) break;
+            if (!CanCollapse(candidate.a, candidate.b, candidate.target)) continue;
+
+            Collapse(candidate.a, candidate.b, candidate.target);
+            acceptedCost = std::max(acceptedCost, candidate.cost);
+            for (uint32_t neighbor : GetNeighbors(candidate.a)) {
+                PushCandidate(candidate.a, neighbor);
+            }
+        }
+        return std::sqrt(acceptedCost);
+    }
+
+    std::vector<TerrainTriangle> GetTriangles(size_t& vertexCount) const {
+        std::vector<TerrainTriangle> triangles;
+        std::vector<bool> used(m_positions.size(), false);
+        for (uint32_t f = 0; f < m_faces.size(); f++) {
+            if (!m_faceAlive[f]) continue;
+            const auto& face = m_faces[f];
+            TerrainTriangle tri;
+            tri.v0 = m_positions[face[0]];
+            tri.v1 = m_positions[face[1]];
+            tri.v2 = m_positions[face[2]];
+            tri.normal = glm::normalize(glm::cross(tri.v1 - tri.v0, tri.v2 - tri.v0));
+            triangles.push_back(tri);
+            for (uint32_t v : face) used[v] = true;
+        }
+        vertexCount = static_cast<size_t>(std::count(used.begin(), used.end(), true));
+        return triangles;
+    }
+
+private:
+    std::vector<glm::vec3> m_positions;
+    std::vector<Quadric> m_quadrics;
+    std::vector<std::array<uint32_t, 3>> m_faces;
+    std::vector<std::vector<uint32_t>> m_vertexFaces;   // May hold dead faces, skipped on use
+    std::vector<uint32_t> m_stamps;                     // Bumped whenever a vertex moves
+    std::vector<bool> m_vertexAlive;
+    std::vector<bool> m_faceAlive;
+    std::priority_queue<CollapseCandidate, std::vector<CollapseCandidate>, std::greater<CollapseCandidate>> m_queue;
+
+    static uint64_t EdgeKey(uint32_t v0, uint32_t v1) {
+        return (static_cast<uint64_t>(std::min(v0, v1)) << 32) | std::max(v0, v1);
+    }
+
+    bool GetFaceNormal(const std::array<uint32_t, 3>& face, glm::dvec3& normal) const {
+        const glm::dvec3 p0(m_positions[face[0]]);
+        normal = glm::cross(glm::dvec3(m_positions[face[1]]) - p0, glm::dvec3(m_positions[face[2]]) - p0);
+        const double length = glm::length(normal);
+        if (length <= 0.0) return false;
+        normal /= length;
+        return true;
+    }
+
+    // True when some live face walks the directed edge v0 -> v1
+    bool HasEdge(uint32_t v0, uint32_t v1) const {
+        for (uint32_t f : m_vertexFaces[v0]) {
+            if (!m_faceAlive[f]) continue;
+            const auto& face = m_faces[f];
+            for (int i = 0; i < 3; i++) {
+                if (face[i] == v0 && face[(i + 1) % 3] == v1) return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<uint32_t> GetNeighbors(uint32_t v) const {
+        std::vector<uint32_t> neighbors;
+        for (uint32_t f : m_vertexFaces[v]) {
+            if (!m_faceAlive[f]) continue;
+            for (uint32_t other : m_faces[f]) {
+                if (other != v) neighbors.push_back(other);
+            }
+        }
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+        return neighbors;
+    }
+
+    void PushCandidate(uint32_t a, uint32_t b) {
+        Quadric q = m_quadrics[a];
+        q += m_quadrics[b];
+
+        // Optimal point when the planes pin one down, otherwise the best of the endpoints and midpoint
+        const glm::dvec3 pa(m_positions[a]), pb(m_positions[b]);
+        glm::dvec3 target;
+        double cost;
+        if (q.Minimize(target)) {
+            cost = q.Evaluate(target);
+        } else {
+            target = pa;
+            cost = q.Evaluate(pa);
+            for (const glm::dvec3& p : {pb, (pa + pb) * 0.5}) {
+                const double c = q.Evaluate(p);
+                if (c < cost) {
+                    cost = c;
+                    target = p;
+                }
+            }
+        }
+        m_queue.push({static_cast<float>(std::max(cost, 0.0)), a, b, m_stamps[a], m_stamps[b], glm::vec3(target)});
+    }
+
+    bool CanCollapse(uint32_t a, uint32_t b, const glm::vec3& target) const {
+        // Link condition: a and b may only share the vertices opposite their shared faces,
+        // anything more would pinch the surface into a non-manifold fold
+        int sharedFaces = 0;
+        for (uint32_t f : m_vertexFaces[a]) {
+            if (!m_faceAlive[f]) continue;
+            const auto& face = m_faces[f];
+            if (face[0] == b || face[1] == b || face[2] == b) sharedFaces++;
+        }
+        const std::vector<uint32_t> neighborsA = GetNeighbors(a);
+        const std::vector<uint32_t> neighborsB = GetNeighbors(b);
+        std::vector<uint32_t> common;
+        std::set_intersection(neighborsA.begin(), neighborsA.end(), neighborsB.begin(), neighborsB.end(),
+            std::back_inserter(common));
+        if (sharedFaces == 0 || static_cast<int>(common.size()) != sharedFaces) return false;
+
+        // Faces that survive must not flip or collapse to slivers
+        for (uint32_t v : {a, b}) {
+            for (uint32_t f : m_vertexFaces[v]) {
+                if (!m_faceAlive[f]) continue;
+                std::array<uint32_t, 3> face = m_faces[f];
+                if ((face[0] == a || face[1] == a || face[2] == a) && (face[0] == b || face[1] == b || face[2] == b)) continue;
+
+                glm::vec3 before[3], after[3];
+                for (int i = 0; i < 3; i++) {
+                    before[i] = m_positions[face[i]];
+                    after[i] = face[i] == v ? target : before[i];
+                }
+                const glm::vec3 oldNormal = glm::cross(before[1] - before[0], before[2] - before[0]);
+                const glm::vec3 newNormal = glm::cross(after[1] - after[0], after[2] - after[0]);
+                const float oldLength = glm::length(oldNormal), newLength = glm::length(newNormal);
+                if (newLength <= 1e-6f * std::max(oldLength, 1e-6f)) return false;
+                if (glm::dot(oldNormal, newNormal) < MIN_NORMAL_DOT * oldLength * newLength) return false;
+            }
+        }
+        return true;
+    }
+
+    void Collapse(uint32_t a, uint32_t b, const glm::vec3& target) {
+        m_positions[a] = target;
+        m_quadrics[a] += m_quadrics[b];
+        for (uint32_t f : m_vertexFaces[b]) {
+            if (!m_faceAlive[f]) continue;
+            auto& face = m_faces[f];
+            if (face[0] == a || face[1] == a || face[2] == a) {
+                m_faceAlive[f] = false;
+                continue;
+            }
+            for (uint32_t& v : face) {
+                if (v == b) v = a;
+            }
+            m_vertexFaces[a].push_back(f);
+        }
+        m_vertexFaces[b].clear();
+        m_vertexFaces[b].shrink_to_fit();
+        m_vertexAlive[b] = false;
+        m_stamps[a]++;
+
+        // Drop the faces that just died so the list doesn't grow without bound
+        auto& faces = m_vertexFaces[a];
+        faces.erase(std::remove_if(faces.begin(), faces.end(), [this](uint32_t f) { return !m_faceAlive[f]; }),
+            faces.end());
+    }
+};
+
+std::vector<TerrainTriangle> SimplifyTerrain(const std::vector<TerrainTriangle>& triangles, float maxError,
+    TerrainProxyStats* stats) {
+    EdgeCollapser collapser(triangles);
+    if (stats) {
+        stats->sourceTriangles = triangles.size();
+        stats->sourceVertices = collapser.GetVertexCount();
+    }
+
+    const float errorBound = maxError > 0.0f ? collapser.Simplify(maxError) : 0.0f;
+    size_t vertexCount = 0;
+    std::vector<TerrainTriangle> proxy = collapser.GetTriangles(vertexCount);
+    if (stats) {
+        stats->proxyTriangles = proxy.size();
+        stats->proxyVertices = vertexCount;
+        stats->errorBound = errorBound;
+    }
+    return proxy;
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+#include "Terrain.hpp"
+#include <vector>
+
+struct TerrainProxyStats {
+    size_t sourceTriangles = 0;
+    size_t sourceVertices = 0;      // After welding shared positions
+    size_t proxyTriangles = 0;
+    size_t proxyVertices = 0;
+    float errorBound = 0.0f;        // Largest plane distance any accepted collapse allowed
+};
+
+// Collision-only proxy of a render mesh by quadric edge collapse. A collapse
+// is accepted only while the merged vertex stays within maxError of every
+// original face plane around it, so the proxy never strays further than that
+// from the source surface. Open edges are held by planes perpendicular to the
+// surface, which keeps the outline of the map in place.
+std::vector<TerrainTriangle> SimplifyTerrain(const std::vector<TerrainTriangle>& triangles, float maxError,
+    TerrainProxyStats* stats = nullptr);
\ No newline at end of file
@@ -0,0 +1,398 @@
+#include "TerrainWorld.hpp"
+#include "Camera.hpp"
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+bool TerrainWorld::Open(const std::string& directory, size_t memoryBudget, float streamRadius,
+    CollisionBuilder builder, ThreadPool& pool) {
+    Close();
+
+    std::ifstream file(directory + "/world.cfg");
+    if (!file) {
+        std::cerr << "ERROR::WORLD::Missing manifest " << directory << "/world.cfg" << std::endl;
+        return false;
+    }
+    float tileSize = 0.0f;
+    int tilesX = 0, tilesZ = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        std::string key, value;
+        if (std::getline(iss, key, '=') && std::getline(iss, value)) {
+            // A malformed value fails the open, the caller falls back to the single map
+            try {
+                if (key == "tile_size") tileSize = std::stof(value);
+                else if (key == "tiles_x") tilesX = std::stoi(value);
+                else if (key == "tiles_z") tilesZ = std::stoi(value);
+            } catch (const std::exception&) {
+                std::cerr << "ERROR::WORLD::Bad value for " << key << " in " << directory << "/world.cfg" << std::endl;
+                return false;
+            }
+        }
+    }
+    // Tile counts are capped so a typo can't ask for billions of tiles
+    const long long MAX_TILES = 1 << 16;
+    if (!std::isfinite(tileSize) || tileSize <= 0.0f || tilesX <= 0 || tilesZ <= 0 ||
+        static_cast<long long>(tilesX) * tilesZ > MAX_TILES) {
+        std::cerr << "ERROR::WORLD::Invalid manifest in " << directory << std::endl;
+        return false;
+    }
+
+    m_tileSize = tileSize;
+    m_tilesX = tilesX;
+    m_tilesZ = tilesZ;
+    m_halfExtent = glm::vec2(tilesX, tilesZ) * (tileSize * 0.5f);
+    m_memoryBudget = memoryBudget;
+    m_streamRadius = streamRadius;
+    m_builder = std::move(builder);
+    m_pool = &pool;
+
+    m_tiles.resize(static_cast<size_t>(tilesX) * tilesZ);
+    unsigned int presentTiles = 0;
+    for (int z = 0; z < tilesZ; z++) {
+        for (int x = 0; x < tilesX; x++) {
+            Tile& tile = m_tiles[z * tilesX + x];
+            tile.path = directory + "/tile_" + std::to_string(x) + "_" + std::to_string(z) + ".obj";
+            std::error_code error;
+            const auto fileBytes = std::filesystem::file_size(tile.path, error);
+            if (!error) {
+                tile.state = TileState::UNLOADED;
+                tile.fileBytes = static_cast<size_t>(fileBytes);
+                presentTiles++;
+            }
+        }
+    }
+
+    std::cout << "World " << directory << ": " << tilesX << "x" << tilesZ << " tiles of " << tileSize
+              << " units, " << presentTiles << " on disk, budget " << memoryBudget / (1024 * 1024) << " MB" << std::endl;
+    return true;
+}
+
+void TerrainWorld::Close() {
+    for (Tile& tile : m_tiles) {
+        if (tile.state == TileState::LOADING) tile.pending.wait();
+        if (tile.VAO) glDeleteVertexArrays(1, &tile.VAO);
+        if (tile.VBO) glDeleteBuffers(1, &tile.VBO);
+        if (tile.EBO) glDeleteBuffers(1, &tile.EBO);
+    }
+    m_tiles.clear();
+    m_pool = nullptr;
+    m_stats = {};
+}
+
+void TerrainWorld::Update(const glm::vec3& focus, const std::vector<glm::vec3>& anchors) {
+    if (!IsActive()) return;
+    const glm::vec2 point(focus.x, focus.z);
+
+    // Tiles around ships jump the queue, callers treat them as solid until they arrive
+    for (Tile& tile : m_tiles) tile.anchored = false;
+    size_t anchoredBytes = 0;
+    for (const glm::vec3& anchor : anchors) {
+        if (!AnchorTiles(anchor, anchoredBytes)) break;
+    }
+    for (Tile& tile : m_tiles) {
+        if (tile.anchored && tile.state == TileState::UNLOADED) RequestLoad(tile, true);
+    }
+
+    // Pick up finished loads, the nearest one not yet on the GPU gets uploaded this frame
+    Tile* nearestUpload = nullptr;
+    float nearestUploadDistance = FLT_MAX;
+    for (int i = 0; i < static_cast<int>(m_tiles.size()); i++) {
+        Tile& tile = m_tiles[i];
+        if (tile.state == TileState::LOADING &&
+            tile.pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            MakeResident(tile, tile.pending.get());
+        }
+        if (tile.state == TileState::RESIDENT && !tile.VAO && !tile.data->indices.empty()) {
+            float distance = DistanceToTile(i % m_tilesX, i / m_tilesX, point);
+            if (distance < nearestUploadDistance) {
+                nearestUploadDistance = distance;
+                nearestUpload = &tile;
+            }
+        }
+    }
+    if (nearestUpload) Upload(*nearestUpload);
+
+    // Drop tiles that left the stream radius, with half a tile of slack so the edge doesn't thrash
+    const float evictRadius = m_streamRadius + m_tileSize * 0.5f;
+    size_t residentBytes = 0;
+    unsigned int residentTiles = 0, loadingTiles = 0;
+    for (int i = 0; i < static_cast<int>(m_tiles.size()); i++) {
+        Tile& tile = m_tiles[i];
+        if (tile.state == TileState::LOADING) loadingTiles++;
+        if (tile.state != TileState::RESIDENT) continue;
+        if (!tile.anchored && DistanceToTile(i % m_tilesX, i / m_tilesX, point) > evictRadius) {
+            Evict(tile);
+            continue;
+        }
+        residentBytes += tile.bytes;
+        residentTiles++;
+    }
+
+    // Still over budget: evict the farthest tiles, anchored ones only when nothing else is
+    // left, since their footprint was capped by an estimate. Never the one under the focus.
+    while (residentBytes > m_memoryBudget) {
+        int farthest = -1;
+        float farthestDistance = 0.0f;
+        bool farthestAnchored = true;
+        for (int i = 0; i < static_cast<int>(m_tiles.size()); i++) {
+            if (m_tiles[i].state != TileState::RESIDENT) continue;
+            float distance = DistanceToTile(i % m_tilesX, i / m_tilesX, point);
+            if (distance <= 0.0f) continue;
+            const bool anchored = m_tiles[i].anchored;
+            if ((farthestAnchored && !anchored) || (anchored == farthestAnchored && distance > farthestDistance)) {
+                farthestDistance = distance;
+                farthestAnchored = anchored;
+                farthest = i;
+            }
+        }
+        if (farthest < 0) break;
+        residentBytes -= m_tiles[farthest].bytes;
+        residentTiles--;
+        Evict(m_tiles[farthest]);
+    }
+
+    // Request the nearest missing tiles while the expected footprint fits the budget
+    m_averageTileBytes = residentTiles ? residentBytes / residentTiles : 0;
+    size_t loadingBytes = 0;
+    for (const Tile& tile : m_tiles) {
+        if (tile.state == TileState::LOADING) loadingBytes += EstimateBytes(tile);
+    }
+    m_candidates.clear();
+    for (int i = 0; i < static_cast<int>(m_tiles.size()); i++) {
+        if (m_tiles[i].state != TileState::UNLOADED) continue;
+        if (DistanceToTile(i % m_tilesX, i / m_tilesX, point) <= m_streamRadius) m_candidates.push_back(i);
+    }
+    std::sort(m_candidates.begin(), m_candidates.end(), [&](int a, int b) {
+        return DistanceToTile(a % m_tilesX, a / m_tilesX, point) < DistanceToTile(b % m_tilesX, b / m_tilesX, point);
+    });
+    for (int i : m_candidates) {
+        // One load per worker keeps the queue short enough to react when the focus moves
+        if (loadingTiles >= m_pool->GetThreadCount()) break;
+        Tile& tile = m_tiles[i];
+        if (residentBytes + loadingBytes + EstimateBytes(tile) > m_memoryBudget) break;
+
+        RequestLoad(tile, false);
+        loadingTiles++;
+        loadingBytes += EstimateBytes(tile);
+    }
+
+    m_stats.residentTiles = residentTiles;
+    m_stats.loadingTiles = loadingTiles;
+    m_stats.residentBytes = residentBytes;
+}
+
+void TerrainWorld::Preload(const std::vector<glm::vec3>& points) {
+    if (!IsActive()) return;
+    size_t anchoredBytes = 0;
+    for (const glm::vec3& point : points) {
+        if (!AnchorTiles(point, anchoredBytes)) break;
+    }
+    // Queue them all first so the loads overlap, then wait
+    for (Tile& tile : m_tiles) {
+        if (tile.anchored && tile.state == TileState::UNLOADED) RequestLoad(tile, true);
+    }
+    for (Tile& tile : m_tiles) {
+        if (tile.anchored && tile.state == TileState::LOADING) MakeResident(tile, tile.pending.get());
+    }
+}
+
+void TerrainWorld::Draw(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& offset, float renderDistance) {
+    m_stats.drawnTiles = 0;
+    const Frustum frustum = Frustum::FromMatrix(projection * view);
+    const glm::vec3 eye = glm::vec3(glm::inverse(view)[3]);
+
+    for (const Tile& tile : m_tiles) {
+        if (!tile.VAO) continue;
+        glm::vec3 boundsMin = tile.data->boundsMin + offset;
+        glm::vec3 boundsMax = tile.data->boundsMax + offset;
+        if (glm::length(glm::clamp(eye, boundsMin, boundsMax) - eye) > renderDistance) continue;
+        if (!frustum.IntersectsAABB(boundsMin, boundsMax)) continue;
+
+        glBindVertexArray(tile.VAO);
+        glDrawElements(GL_TRIANGLES, tile.indexCount, GL_UNSIGNED_INT, 0);
+        m_stats.drawnTiles++;
+    }
+    glBindVertexArray(0);
+}
+
+const TerrainCollision* TerrainWorld::FindCollision(float x, float z) const {
+    const int index = GetTileIndex(x, z);
+    if (index < 0) return nullptr;
+
+    const Tile& tile = m_tiles[index];
+    return tile.state == TileState::RESIDENT ? tile.data->collision.get() : nullptr;
+}
+
+bool TerrainWorld::IsStreaming(float x, float z) const {
+    const int index = GetTileIndex(x, z);
+    return index >= 0 && (m_tiles[index].state == TileState::UNLOADED || m_tiles[index].state == TileState::LOADING);
+}
+
+std::unique_ptr<TerrainWorld::TileData> TerrainWorld::LoadTile(const std::string& path, const CollisionBuilder& builder) {
+    auto data = std::make_unique<TileData>();
+
+    // Importers aren't thread-safe, each load gets its own
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenNormals);
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) {
+        std::cerr << "ERROR::ASSIMP::" << importer.GetErrorString() << std::endl;
+        return data;
+    }
+
+    std::vector<TerrainTriangle> triangles;
+    data->boundsMin = glm::vec3(FLT_MAX);
+    data->boundsMax = glm::vec3(-FLT_MAX);
+    for (unsigned int m = 0; m < scene->mNumMeshes; m++) {
+        const aiMesh* mesh = scene->mMeshes[m];
+        const unsigned int baseVertex = static_cast<unsigned int>(data->vertices.size() / 9);
+
+        for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
+            glm::vec3 position(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+            glm::vec3 normal = mesh->HasNormals()
+                ? glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z)
+                : glm::vec3(0.0f, 1.0f, 0.0f);
+            data->vertices.insert(data->vertices.end(), {
+                position.x, position.y, position.z,
+                0.7f, 0.7f, 0.7f,
+                normal.x, normal.y, normal.z});
+            data->boundsMin = glm::min(data->boundsMin, position);
+            data->boundsMax = glm::max(data->boundsMax, position);
+        }
+
+        for (unsigned int f = 0; f < mesh->mNumFaces; f++) {
+            const aiFace& face = mesh->mFaces[f];
+            if (face.mNumIndices != 3) continue;
+
+            TerrainTriangle tri;
+            tri.v0 = glm::vec3(mesh->mVertices[face.mIndices[0]].x, mesh->mVertices[face.mIndices[0]].y, mesh->mVertices[face.mIndices[0]].z);
+            tri.v1 = glm::vec3(mesh->mVertices[face.mIndices[1]].x, mesh->mVertices[face.mIndices[1]].y, mesh->mVertices[face.mIndices[1]].z);
+            tri.v2 = glm::vec3(mesh->mVertices[face.mIndices[2]].x, mesh->mVertices[face.mIndices[2]].y, mesh->mVertices[face.mIndices[2]].z);
+            tri.normal = glm::normalize(glm::cross(tri.v1 - tri.v0, tri.v2 - tri.v0));
+            triangles.push_back(tri);
+
+            for (unsigned int j = 0; j < 3; j++) {
+                data->indices.push_back(baseVertex + face.mIndices[j]);
+            }
+        }
+    }
+
+    if (!triangles.empty()) data->collision = builder(path, std::move(triangles));
+    return data;
+}
+
+void TerrainWorld::MakeResident(Tile& tile, std::unique_ptr<TileData> data) {
+    tile.data = std::move(data);
+    tile.bytes = tile.data->vertices.size() * sizeof(float) + tile.data->indices.size() * sizeof(unsigned int) +
+                 (tile.data->collision ? tile.data->collision->GetMemoryUsage() : 0);
+    tile.state = TileState::RESIDENT;
+}
+
+void TerrainWorld::RequestLoad(Tile& tile, bool urgent) {
+    const CollisionBuilder& builder = m_builder;
+    tile.pending = m_pool->Submit([path = tile.path, &builder]() { return LoadTile(path, builder); }, urgent);
+    tile.state = TileState::LOADING;
+}
+
+bool TerrainWorld::AnchorTiles(const glm::vec3& anchor, size_t& anchoredBytes) {
+    int startX, endX, startZ, endZ;
+    if (!GetTileRange(glm::vec2(anchor.x, anchor.z) - ANCHOR_MARGIN, glm::vec2(anchor.x, anchor.z) + ANCHOR_MARGIN,
+            startX, endX, startZ, endZ)) return true;
+
+    // All or nothing per anchor, a ship with half its ground pinned gains little
+    size_t bytes = 0;
+    for (int z = startZ; z <= endZ; z++) {
+        for (int x = startX; x <= endX; x++) {
+            const Tile& tile = m_tiles[z * m_tilesX + x];
+            if (tile.state == TileState::EMPTY || tile.anchored) continue;
+            bytes += tile.state == TileState::RESIDENT ? tile.bytes : EstimateBytes(tile);
+        }
+    }
+    if (anchoredBytes + bytes > m_memoryBudget) return false;
+    anchoredBytes += bytes;
+
+    for (int z = startZ; z <= endZ; z++) {
+        for (int x = startX; x <= endX; x++) {
+            Tile& tile = m_tiles[z * m_tilesX + x];
+            if (tile.state != TileState::EMPTY) tile.anchored = true;
+        }
+    }
+    return true;
+}
+
+size_t TerrainWorld::EstimateBytes(const Tile& tile) const {
+    // Resident tiles give the estimate, before the first one arrives the file size stands in for it
+    return m_averageTileBytes ? m_averageTileBytes : tile.fileBytes;
+}
+
+void TerrainWorld::Upload(Tile& tile) {
+    TileData& data = *tile.data;
+    glGenVertexArrays(1, &tile.VAO);
+    glGenBuffers(1, &tile.VBO);
+    glGenBuffers(1, &tile.EBO);
+    glBindVertexArray(tile.VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, tile.VBO);
+    glBufferData(GL_ARRAY_BUFFER, data.vertices.size() * sizeof(float), data.vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, tile.EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.indices.size() * sizeof(unsigned int), data.indices.data(), GL_STATIC_DRAW);
+
+    const GLsizei stride = 9 * sizeof(float);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    glBindVertexArray(0);
+
+    // The GPU owns the mesh now, bytes keep counting it against the budget
+    tile.indexCount = static_cast<GLsizei>(data.indices.size());
+    std::vector<float>().swap(data.vertices);
+    std::vector<unsigned int>().swap(data.indices);
+}
+
+void TerrainWorld::Evict(Tile& tile) {
+    if (tile.VAO) glDeleteVertexArrays(1, &tile.VAO);
+    if (tile.VBO) glDeleteBuffers(1, &tile.VBO);
+    if (tile.EBO) glDeleteBuffers(1, &tile.EBO);
+    tile.VAO = tile.VBO = tile.EBO = 0;
+    tile.indexCount = 0;
+    tile.bytes = 0;
+    tile.state = TileState::UNLOADED;
+
+    // Freeing a baked tile touches megabytes, let a worker do it
+    m_pool->Submit([data = std::move(tile.data)]() mutable { data.reset(); });
+}
+
+float TerrainWorld::DistanceToTile(int x, int z, const glm::vec2& point) const {
+    glm::vec2 tileMin = glm::vec2(x, z) * m_tileSize - m_halfExtent;
+    glm::vec2 nearest = glm::clamp(point, tileMin, tileMin + glm::vec2(m_tileSize));
+    return glm::length(nearest - point);
+}
+
+int TerrainWorld::GetTileIndex(float x, float z) const {
+    if (!IsActive()) return -1;
+    int tileX = static_cast<int>(std::floor((x + m_halfExtent.x) / m_tileSize));
+    int tileZ = static_cast<int>(std::floor((z + m_halfExtent.y) / m_tileSize));
+    if (tileX < 0 || tileX >= m_tilesX || tileZ < 0 || tileZ >= m_tilesZ) return -1;
+    return tileZ * m_tilesX + tileX;
+}
+
+bool TerrainWorld::GetTileRange(const glm::vec2& minXZ, const glm::vec2& maxXZ,
+    int& startX, int& endX, int& startZ, int& endZ) const {
+    if (!IsActive()) return false;
+    startX = std::max(0, static_cast<int>(std::floor((minXZ.x + m_halfExtent.x) / m_tileSize)));
+    startZ = std::max(0, static_cast<int>(std::floor((minXZ.y + m_halfExtent.y) / m_tileSize)));
+    endX = std::min(m_tilesX - 1, static_cast<int>(std::floor((maxXZ.x + m_halfExtent.x) / m_tileSize)));
+    endZ = std::min(m_tilesZ - 1, static_cast<int>(std::floor((maxXZ.y + m_halfExtent.y) / m_tileSize)));
+    return startX <= endX && startZ <= endZ;
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Terrain.hpp"
+#include "ThreadPool.hpp"
+
+// Tiled world streamed around a focus point. The world directory holds a
+// world.cfg manifest (tile_size, tiles_x, tiles_z) and one tile_<x>_<z>.obj
+// per tile in world coordinates, centered on the origin. Missing tiles are
+// treated as empty. Tiles load and bake on the thread pool; the main thread
+// only uploads finished meshes, at most one per Update. Tiles under an anchor
+// jump the load queue and stay until the anchor leaves, within the same budget.
+class TerrainWorld {
+public:
+    // Called on a worker thread with the tile's path and triangles
+    using CollisionBuilder = std::function<std::unique_ptr<TerrainCollision>(
+        const std::string& tilePath, std::vector<TerrainTriangle> triangles)>;
+
+    struct Stats {
+        unsigned int residentTiles;
+        unsigned int loadingTiles;
+        unsigned int drawnTiles;
+        size_t residentBytes;
+    };
+
+    ~TerrainWorld() { Close(); }
+
+    bool Open(const std::string& directory, size_t memoryBudget, float streamRadius,
+        CollisionBuilder builder, ThreadPool& pool);
+    // Waits for in-flight loads, then frees every tile
+    void Close();
+
+    // Streams tiles in and out around focus. Anchors (live ships, most important first)
+    // keep the tiles within ANCHOR_MARGIN of them loaded while those fit the budget; main thread only
+    void Update(const glm::vec3& focus, const std::vector<glm::vec3>& anchors);
+    // Blocks until the tiles under points are resident, for match start where a stall is expected
+    void Preload(const std::vector<glm::vec3>& points);
+    // Expects the terrain shader to be bound with its model matrix set to offset
+    void Draw(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& offset, float renderDistance);
+
+    bool IsActive() const { return m_pool != nullptr; }
+    // Half extent of the world along its shorter axis
+    float GetBoundary() const { return std::min(m_halfExtent.x, m_halfExtent.y); }
+    const Stats& GetStats() const { return m_stats; }
+
+    // Collision for the resident tile under (x, z), nullptr while it is unloaded
+    const TerrainCollision* FindCollision(float x, float z) const;
+    // True over a tile that exists on disk but isn't resident yet
+    bool IsStreaming(float x, float z) const;
+
+    // Visits the collision of every resident tile overlapping the XZ rectangle
+    template <typename F>
+    void ForEachCollision(const glm::vec2& minXZ, const glm::vec2& maxXZ, F&& visit) const {
+        int startX, endX, startZ, endZ;
+        if (!GetTileRange(minXZ, maxXZ, startX, endX, startZ, endZ)) return;
+        for (int z = startZ; z <= endZ; z++) {
+            for (int x = startX; x <= endX; x++) {
+                const Tile& tile = m_tiles[z * m_tilesX + x];
+                if (tile.state == TileState::RESIDENT && tile.data->collision) visit(*tile.data->collision);
+            }
+        }
+    }
+
+private:
+    // Everything a worker produces for one tile
+    struct TileData {
+        std::vector<float> vertices;            // Interleaved position, color, normal
+        std::vector<unsigned int> indices;
+        glm::vec3 boundsMin{0.0f};
+        glm::vec3 boundsMax{0.0f};
+        std::unique_ptr<TerrainCollision> collision;
+    };
+
+    enum class TileState {
+        EMPTY,          // No file on disk
+        UNLOADED,
+        LOADING,
+        RESIDENT,
+    };
+
+    struct Tile {
+        TileState state = TileState::EMPTY;
+        std::string path;
+        std::future<std::unique_ptr<TileData>> pending;
+        std::unique_ptr<TileData> data;
+        GLuint VAO = 0, VBO = 0, EBO = 0;
+        GLsizei indexCount = 0;
+        size_t bytes = 0;
+        size_t fileBytes = 0;                   // Load estimate until a resident tile gives a better one
+        bool anchored = false;                  // Under an anchor this update, never evicted
+    };
+
+    // Distance an anchor may move before its next Update without leaving resident terrain
+    static constexpr float ANCHOR_MARGIN = 8.0f;
+
+    static std::unique_ptr<TileData> LoadTile(const std::string& path, const CollisionBuilder& builder);
+    void MakeResident(Tile& tile, std::unique_ptr<TileData> data);
+    void RequestLoad(Tile& tile, bool urgent);
+    // Marks the tiles around an anchor, false once the anchored footprint would exceed the budget
+    bool AnchorTiles(const glm::vec3& anchor, size_t& anchoredBytes);
+    size_t EstimateBytes(const Tile& tile) const;
+    int GetTileIndex(float x, float z) const;
+    void Upload(Tile& tile);
+    void Evict(Tile& tile);
+    float DistanceToTile(int x, int z, const glm::vec2& point) const;
+    bool GetTileRange(const glm::vec2& minXZ, const glm::vec2& maxXZ,
+        int& startX, int& endX, int& startZ, int& endZ) const;
+
+    ThreadPool* m_pool = nullptr;
+    CollisionBuilder m_builder;
+    size_t m_memoryBudget = 0;
+    float m_streamRadius = 0.0f;
+    float m_tileSize = 0.0f;
+    glm::vec2 m_halfExtent{0.0f};
+    int m_tilesX = 0;
+    int m_tilesZ = 0;
+    std::vector<Tile> m_tiles;
+    std::vector<int> m_candidates;              // Per-update scratch
+    size_t m_averageTileBytes = 0;              // Over resident tiles at the last Update, 0 before the first
+    Stats m_stats = {};
+};
\ No newline at end of file
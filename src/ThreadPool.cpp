@@ -0,0 +1,83 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(unsigned int threadCount) {
+    if (threadCount == 0) {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+    m_workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; i++) {
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    // Workers finish whatever is still queued before exiting
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::WorkerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+            if (m_tasks.empty()) return;
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::ParallelFor(int count, int grainSize, const std::function<void(int, int)>& work) {
+    if (count <= 0) return;
+    grainSize = std::max(grainSize, 1);
+    const int blockCount = (count + grainSize - 1) / grainSize;
+    if (blockCount == 1) {
+        work(0, count);
+        return;
+    }
+
+    // Helpers that start after the last block was claimed return without touching work
+    struct Shared {
+        std::atomic<int> nextBlock{0};
+        std::atomic<int> finishedBlocks{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto shared = std::make_shared<Shared>();
+    auto runBlocks = [shared, &work, count, grainSize, blockCount]() {
+        for (;;) {
+            const int block = shared->nextBlock.fetch_add(1);
+            if (block >= blockCount) return;
+            work(block * grainSize, std::min(count, (block + 1) * grainSize));
+            if (shared->finishedBlocks.fetch_add(1) + 1 == blockCount) {
+                std::lock_guard<std::mutex> lock(shared->mutex);
+                shared->finished.notify_all();
+            }
+        }
+    };
+
+    const unsigned int helperCount = std::min(GetThreadCount(), static_cast<unsigned int>(blockCount - 1));
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (unsigned int i = 0; i < helperCount; i++) {
+            m_tasks.emplace_back(runBlocks);
+        }
+    }
+    m_wake.notify_all();
+
+    runBlocks();
+    std::unique_lock<std::mutex> lock(shared->mutex);
+    shared->finished.wait(lock, [&]() { return shared->finishedBlocks.load() == blockCount; });
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads draining a FIFO task queue. Tasks must not
+// touch OpenGL, only the main thread owns the context.
+class ThreadPool {
+public:
+    // 0 picks one thread less than the hardware has, leaving a core for the main thread
+    explicit ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Urgent tasks go to the front of the queue, ahead of everything already waiting
+    template <typename F>
+    auto Submit(F&& task, bool urgent = false) -> std::future<decltype(task())> {
+        using Result = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (urgent) m_tasks.emplace_front([packaged]() { (*packaged)(); });
+            else m_tasks.emplace_back([packaged]() { (*packaged)(); });
+        }
+        m_wake.notify_one();
+        return result;
+    }
+
+    // Splits [0, count) into grainSize blocks and runs work(begin, end) on them from the
+    // workers and the calling thread. Returns once every block is done; safe to call
+    // from inside a pool task since the caller never waits on queued work.
+    void ParallelFor(int count, int grainSize, const std::function<void(int, int)>& work);
+
+    unsigned int GetThreadCount() const { return static_cast<unsigned int>(m_workers.size()); }
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+};
\ No newline at end of file